@@ -0,0 +1,42 @@
+# xorstr_embed(<target> NAME <identifier> FILE <path> [NAMESPACE <namespace>])
+#
+# 在构建时把 <path> 转换成头文件 <xorstr_embed/<identifier>.hpp>，其中定义
+# `inline constexpr auto <namespace>::<identifier>`（fantasy::xorblob），文件内容在编译期加密，
+# 二进制中只有密文，运行期通过 read(offset, span) 按需解密，不再需要读取文件。
+# 编译器支持 #embed 时直接嵌入原文件，否则使用生成的字节列表。
+
+set(XORSTR_EMBED_GENERATOR ${CMAKE_CURRENT_LIST_DIR}/xorstr_embed_generate.cmake)
+
+function(xorstr_embed target)
+    cmake_parse_arguments(PARSE_ARGV 1 XORSTR_EMBED "" "NAME;FILE;NAMESPACE" "")
+    if (NOT XORSTR_EMBED_NAME OR NOT XORSTR_EMBED_FILE)
+        message(FATAL_ERROR "xorstr_embed: NAME and FILE are required")
+    endif()
+    if (NOT XORSTR_EMBED_NAMESPACE)
+        set(XORSTR_EMBED_NAMESPACE xorstr_embedded)
+    endif()
+
+    get_filename_component(input ${XORSTR_EMBED_FILE} ABSOLUTE)
+    # 种子只用相对源码根目录的路径，同一份源码检出到不同目录时密文相同
+    file(RELATIVE_PATH source_path ${CMAKE_SOURCE_DIR} ${input})
+    # 每个目标各自生成一份头文件：同一个输出不能出现在多个互不依赖的目标里，否则并行构建会同时写它
+    set(include_dir ${CMAKE_CURRENT_BINARY_DIR}/xorstr_embed_include/${target})
+    set(header ${include_dir}/xorstr_embed/${XORSTR_EMBED_NAME}.hpp)
+
+    add_custom_command(
+        OUTPUT ${header}
+        COMMAND ${CMAKE_COMMAND}
+            -DXORSTR_EMBED_INPUT=${input}
+            -DXORSTR_EMBED_OUTPUT=${header}
+            -DXORSTR_EMBED_NAME=${XORSTR_EMBED_NAME}
+            -DXORSTR_EMBED_NAMESPACE=${XORSTR_EMBED_NAMESPACE}
+            -DXORSTR_EMBED_SOURCE_PATH=${source_path}
+            -DXORSTR_EMBED_BUILD_SEED=${XORSTR_BUILD_SEED}
+            -P ${XORSTR_EMBED_GENERATOR}
+        DEPENDS ${input} ${XORSTR_EMBED_GENERATOR}
+        COMMENT "Encrypting ${XORSTR_EMBED_FILE} into xorstr_embed/${XORSTR_EMBED_NAME}.hpp"
+        VERBATIM
+    )
+    target_sources(${target} PRIVATE ${header})
+    target_include_directories(${target} PRIVATE ${include_dir})
+endfunction()
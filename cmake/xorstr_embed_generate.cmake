@@ -0,0 +1,45 @@
+# 由 xorstr_embed() 在构建时调用：cmake -DXORSTR_EMBED_INPUT=... -DXORSTR_EMBED_OUTPUT=... -P <this file>
+
+file(READ ${XORSTR_EMBED_INPUT} content HEX)
+string(LENGTH "${content}" hex_length)
+if (hex_length EQUAL 0)
+    message(FATAL_ERROR "xorstr_embed: ${XORSTR_EMBED_INPUT} is empty")
+endif()
+
+# 每行 16 个字节（CMake 正则不支持 {n} 重复次数）
+string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," bytes "${content}")
+set(line_pattern "")
+foreach(i RANGE 1 16)
+    string(APPEND line_pattern "0x..,")
+endforeach()
+string(REGEX REPLACE "(${line_pattern})" "\\1\n" bytes "${bytes}")
+
+# 种子只取决于资源名、相对源码根目录的路径与 XORSTR_BUILD_SEED，保证同一资源在所有翻译单元中的定义一致
+# （inline 变量不能违反 ODR），且不含绝对路径，换一个检出目录仍然得到相同的密文
+set(seed_input "${XORSTR_EMBED_NAMESPACE}::${XORSTR_EMBED_NAME}:${XORSTR_EMBED_SOURCE_PATH}:${XORSTR_EMBED_BUILD_SEED}")
+string(SHA256 digest "${seed_input}")
+string(SUBSTRING ${digest} 0 16 seed)
+
+file(WRITE ${XORSTR_EMBED_OUTPUT} "// 由 xorstr_embed() 生成，请勿手动修改
+#pragma once
+#include <fantasy/xorstr_blob.hpp>
+
+namespace ${XORSTR_EMBED_NAMESPACE} {
+    inline constexpr auto ${XORSTR_EMBED_NAME} = [] {
+        // 只在常量求值中使用，不会出现在目标文件里
+        constexpr unsigned char plain[] = {
+#if defined(__has_embed)
+#if __has_embed(\"${XORSTR_EMBED_INPUT}\")
+#define XORSTR_EMBED_DIRECTIVE 1
+#embed \"${XORSTR_EMBED_INPUT}\"
+#endif
+#endif
+#if !defined(XORSTR_EMBED_DIRECTIVE)
+${bytes}
+#endif
+#undef XORSTR_EMBED_DIRECTIVE
+        };
+        return fantasy::make_xorblob<0x${seed}ULL>(plain);
+    }();
+} // namespace ${XORSTR_EMBED_NAMESPACE}
+")
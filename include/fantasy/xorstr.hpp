@@ -1,8 +1,99 @@
 #pragma once
-#include <immintrin.h>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define XORSTR_ARCH_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+#define XORSTR_ARCH_NEON 1
+#include <arm_neon.h>
+#endif
+
+// GCC/Clang 需要 target 属性才能在未开启 -mavx2 的翻译单元中使用对应的内建函数，MSVC 不需要
+#if defined(__GNUC__) || defined(__clang__)
+#define XORSTR_TARGET(isa) __attribute__((target(isa)))
+#else
+#define XORSTR_TARGET(isa)
+#endif
+
+// 常量求值时改走标量路径；不支持 if consteval 的 C++20 编译器退回 std::is_constant_evaluated()
+#if defined(__cpp_if_consteval)
+#define XORSTR_IF_CONSTEVAL if consteval
+#else
+#define XORSTR_IF_CONSTEVAL if (std::is_constant_evaluated())
+#endif
+
+// 解密允许使用的最大向量宽度（位）：128 / 256 / 512。
+// 取 128 时只使用 XMM，热路径上不会插入 vzeroupper，也不会触发 AVX 频率切换
+#ifndef XORSTR_VECTOR_WIDTH
+#define XORSTR_VECTOR_WIDTH 512
+#endif
+static_assert(XORSTR_VECTOR_WIDTH == 128 || XORSTR_VECTOR_WIDTH == 256 || XORSTR_VECTOR_WIDTH == 512,
+              "XORSTR_VECTOR_WIDTH must be 128, 256 or 512");
+
+// x86 上默认启用运行期 CPUID 分派；若编译目标已经达到允许的最大宽度则没有更宽的内核可选
+#ifndef XORSTR_RUNTIME_DISPATCH
+#if defined(XORSTR_ARCH_X86) && XORSTR_VECTOR_WIDTH > 128 && !defined(__AVX512F__) &&                                 \
+    !(defined(__AVX2__) && XORSTR_VECTOR_WIDTH == 256)
+#define XORSTR_RUNTIME_DISPATCH 1
+#else
+#define XORSTR_RUNTIME_DISPATCH 0
+#endif
+#endif
+
+// 置 1 时为每个调用点统计解密次数、字节数与耗时（周期），见 xorstr_stats()；置 0 时不生成任何统计代码
+#ifndef XORSTR_ENABLE_STATS
+#define XORSTR_ENABLE_STATS 0
+#endif
+#if XORSTR_ENABLE_STATS
+#include <chrono>
+#include <cstdio>
+#include <source_location>
+#include <vector>
+#endif
+
+// 置 1 时不再生成 .rodata 密钥表，解密时由每个调用点的 64 位种子在寄存器中展开密钥流
+#ifndef XORSTR_REGISTER_KEYS
+#define XORSTR_REGISTER_KEYS 0
+#endif
+
+// 密文、密钥表与明文缓冲区的对齐（字节）。0（默认）按长度选择：短于 XORSTR_WIDE_STORAGE_BYTES 的对象
+// 使用 8 字节自然对齐，栈上构造时函数不需要重新对齐栈（and rsp, -32 与帧指针）；更长的对象按 32 字节对齐。
+// 解密内核全部使用非对齐加载，任何取值都不影响正确性
+#ifndef XORSTR_STORAGE_ALIGNMENT
+#define XORSTR_STORAGE_ALIGNMENT 0
+#endif
+#ifndef XORSTR_WIDE_STORAGE_BYTES
+#define XORSTR_WIDE_STORAGE_BYTES 256
+#endif
+static_assert(XORSTR_STORAGE_ALIGNMENT == 0 ||
+                  (XORSTR_STORAGE_ALIGNMENT >= 8 && (XORSTR_STORAGE_ALIGNMENT & (XORSTR_STORAGE_ALIGNMENT - 1)) == 0),
+              "XORSTR_STORAGE_ALIGNMENT must be 0 or a power of two no smaller than 8");
+
+// 置 1 时按字面量内容派生种子：相同内容的调用点得到相同的类型与密文，密文与密钥表都是 inline 变量，
+// 链接时跨翻译单元合并为一份（COMDAT），见 XORSTR_ENCRYPT
+#ifndef XORSTR_DEDUP
+#define XORSTR_DEDUP 0
+#endif
+
 namespace fantasy {
     /**
      * @brief 编译期索引哈希函数 (Optimized for constexpr)
@@ -32,58 +123,1861 @@ namespace fantasy {
         return (value + alignment - 1) & ~(alignment - 1);
     }
 
-    template <typename CharT, size_t N>
-    constexpr uint64_t xor_block(const CharT (&str)[N], uint32_t block_index, uint64_t key) {
-        constexpr size_t total_bytes = sizeof(CharT) * N;
-        uint64_t value{0};
-        size_t offset = block_index * sizeof(uint64_t) / sizeof(CharT);
+    namespace detail {
+        /**
+         * @brief Bytes 字节的加密存储使用的对齐，见 XORSTR_STORAGE_ALIGNMENT
+         */
+        template <std::size_t Bytes>
+        inline constexpr std::size_t storage_alignment = XORSTR_STORAGE_ALIGNMENT != 0 ? XORSTR_STORAGE_ALIGNMENT
+                                                         : Bytes >= XORSTR_WIDE_STORAGE_BYTES ? 32
+                                                                                              : alignof(uint64_t);
+
+        /**
+         * @brief 解密内核可用的指令集，按宽度递增排列
+         */
+        enum class isa : uint8_t { scalar, sse2, avx2, avx512, neon };
+
+        /**
+         * @brief 异或内核签名：dst[i] = src[i] ^ key[i]，按 64 位字计数。
+         * dst 可以与 src 相同（原地解密），也可以是调用方任意对齐的缓冲区。
+         */
+        using xor_kernel = void (*)(void *dst, const uint64_t *src, const uint64_t *key, std::size_t words) noexcept;
+
+        /**
+         * @brief 按 64 位字写入不保证对齐的目标缓冲区，编译器会生成单条 mov
+         */
+        inline void store_word(void *dst, std::size_t index, uint64_t value) noexcept {
+            std::memcpy(static_cast<unsigned char *>(dst) + index * sizeof(uint64_t), &value, sizeof(value));
+        }
+
+        inline uint64_t load_word(const void *src, std::size_t index) noexcept {
+            uint64_t value;
+            std::memcpy(&value, static_cast<const unsigned char *>(src) + index * sizeof(uint64_t), sizeof(value));
+            return value;
+        }
+
+        inline void xor_words_scalar(void *dst, const uint64_t *src, const uint64_t *key, std::size_t words) noexcept {
+            for (std::size_t i = 0; i < words; ++i) {
+                store_word(dst, i, src[i] ^ key[i]);
+            }
+        }
+
+#if defined(XORSTR_ARCH_X86)
+        XORSTR_TARGET("sse2")
+        inline void xor_words_sse2(void *dst, const uint64_t *src, const uint64_t *key, std::size_t words) noexcept {
+            auto *out = static_cast<unsigned char *>(dst);
+            std::size_t i = 0;
+            for (; i + 2 <= words; i += 2) {
+                const __m128i encrypted_data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+                const __m128i key_mask = _mm_loadu_si128(reinterpret_cast<const __m128i *>(key + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i * sizeof(uint64_t)),
+                                 _mm_xor_si128(encrypted_data, key_mask));
+            }
+            for (; i < words; ++i) {
+                store_word(dst, i, src[i] ^ key[i]);
+            }
+        }
+
+        XORSTR_TARGET("avx2")
+        inline void xor_words_avx2(void *dst, const uint64_t *src, const uint64_t *key, std::size_t words) noexcept {
+            auto *out = static_cast<unsigned char *>(dst);
+            std::size_t i = 0;
+            for (; i + 4 <= words; i += 4) {
+                const __m256i encrypted_data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+                const __m256i key_mask = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(key + i));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i * sizeof(uint64_t)),
+                                    _mm256_xor_si256(encrypted_data, key_mask));
+            }
+            // 尾部最多 3 个字：一次 XMM 加一次 GPR，不越界读写
+            if (i + 2 <= words) {
+                const __m128i encrypted_data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+                const __m128i key_mask = _mm_loadu_si128(reinterpret_cast<const __m128i *>(key + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i * sizeof(uint64_t)),
+                                 _mm_xor_si128(encrypted_data, key_mask));
+                i += 2;
+            }
+            if (i < words) {
+                store_word(dst, i, src[i] ^ key[i]);
+            }
+        }
+
+        XORSTR_TARGET("avx512f")
+        inline void xor_words_avx512(void *dst, const uint64_t *src, const uint64_t *key, std::size_t words) noexcept {
+            auto *out = static_cast<unsigned char *>(dst);
+            std::size_t i = 0;
+            for (; i + 8 <= words; i += 8) {
+                const __m512i encrypted_data = _mm512_loadu_si512(src + i);
+                const __m512i key_mask = _mm512_loadu_si512(key + i);
+                _mm512_storeu_si512(out + i * sizeof(uint64_t), _mm512_xor_si512(encrypted_data, key_mask));
+            }
+            if (i < words) {
+                // 尾部不足 64 字节的部分用掩码加载/存储一次完成
+                const __mmask8 tail = static_cast<__mmask8>((1u << (words - i)) - 1);
+                const __m512i encrypted_data = _mm512_maskz_loadu_epi64(tail, src + i);
+                const __m512i key_mask = _mm512_maskz_loadu_epi64(tail, key + i);
+                _mm512_mask_storeu_epi64(out + i * sizeof(uint64_t), tail, _mm512_xor_si512(encrypted_data, key_mask));
+            }
+        }
+#endif
+
+#if defined(XORSTR_ARCH_NEON)
+        inline void xor_words_neon(void *dst, const uint64_t *src, const uint64_t *key, std::size_t words) noexcept {
+            auto *out = static_cast<uint8_t *>(dst);
+            std::size_t i = 0;
+            for (; i + 2 <= words; i += 2) {
+                const uint64x2_t decrypted_data = veorq_u64(vld1q_u64(src + i), vld1q_u64(key + i));
+                vst1q_u8(out + i * sizeof(uint64_t), vreinterpretq_u8_u64(decrypted_data));
+            }
+            for (; i < words; ++i) {
+                store_word(dst, i, src[i] ^ key[i]);
+            }
+        }
+#endif
+
+        /**
+         * @brief 由编译目标的指令集宏决定的最宽内核，可被内联
+         */
+        inline constexpr isa compiletime_isa =
+#if defined(__AVX512F__) && XORSTR_VECTOR_WIDTH >= 512
+            isa::avx512;
+#elif defined(__AVX2__) && XORSTR_VECTOR_WIDTH >= 256
+            isa::avx2;
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+            isa::sse2;
+#elif defined(XORSTR_ARCH_NEON)
+            isa::neon;
+#else
+            isa::scalar;
+#endif
+
+        /**
+         * @brief 查询当前 CPU（及操作系统）是否支持指定指令集
+         */
+        [[nodiscard]] inline bool cpu_supports(isa level) noexcept {
+            switch (level) {
+            case isa::scalar:
+                return true;
+#if defined(XORSTR_ARCH_X86)
+#if defined(_MSC_VER) && !defined(__clang__)
+            case isa::sse2:
+            case isa::avx2:
+            case isa::avx512: {
+                int regs[4]{};
+                __cpuid(regs, 1);
+                if (level == isa::sse2) {
+                    return (regs[3] & (1 << 26)) != 0;
+                }
+                // OSXSAVE + AVX，且操作系统保存了 YMM（及 AVX-512 的 ZMM/掩码）状态
+                if ((regs[2] & (1 << 27)) == 0 || (regs[2] & (1 << 28)) == 0) {
+                    return false;
+                }
+                const unsigned long long xcr0 = _xgetbv(0);
+                __cpuidex(regs, 7, 0);
+                if (level == isa::avx2) {
+                    return (xcr0 & 0x6) == 0x6 && (regs[1] & (1 << 5)) != 0;
+                }
+                return (xcr0 & 0xE6) == 0xE6 && (regs[1] & (1 << 16)) != 0;
+            }
+#else
+            case isa::sse2:
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("sse2");
+            case isa::avx2:
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("avx2");
+            case isa::avx512:
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("avx512f");
+#endif
+#endif
+#if defined(XORSTR_ARCH_NEON)
+            case isa::neon:
+                return true;
+#endif
+            default:
+                return false;
+            }
+        }
+
+        [[nodiscard]] inline xor_kernel kernel_for(isa level) noexcept {
+            switch (level) {
+#if defined(XORSTR_ARCH_X86)
+            case isa::sse2:
+                return &xor_words_sse2;
+            case isa::avx2:
+                return &xor_words_avx2;
+            case isa::avx512:
+                return &xor_words_avx512;
+#endif
+#if defined(XORSTR_ARCH_NEON)
+            case isa::neon:
+                return &xor_words_neon;
+#endif
+            default:
+                return &xor_words_scalar;
+            }
+        }
+
+        /**
+         * @brief 指令集的向量宽度是否在 XORSTR_VECTOR_WIDTH 允许的范围内
+         */
+        [[nodiscard]] constexpr bool width_allows(isa level) noexcept {
+            return (level != isa::avx2 || XORSTR_VECTOR_WIDTH >= 256) &&
+                   (level != isa::avx512 || XORSTR_VECTOR_WIDTH >= 512);
+        }
+
+        /**
+         * @brief 运行期可用的最宽指令集（不会低于编译期指令集，也不会超过 XORSTR_VECTOR_WIDTH）
+         */
+        [[nodiscard]] inline isa runtime_isa() noexcept {
+            for (const isa level : {isa::avx512, isa::avx2, isa::sse2, isa::neon}) {
+                if (level >= compiletime_isa && width_allows(level) && cpu_supports(level)) {
+                    return level;
+                }
+            }
+            return compiletime_isa;
+        }
+
+        /**
+         * @brief 编译期选择的内核，直接调用以便内联
+         */
+        inline void xor_words_static(void *dst, const uint64_t *src, const uint64_t *key, std::size_t words) noexcept {
+            if constexpr (compiletime_isa == isa::avx512) {
+#if defined(XORSTR_ARCH_X86)
+                xor_words_avx512(dst, src, key, words);
+#endif
+            } else if constexpr (compiletime_isa == isa::avx2) {
+#if defined(XORSTR_ARCH_X86)
+                xor_words_avx2(dst, src, key, words);
+#endif
+            } else if constexpr (compiletime_isa == isa::sse2) {
+#if defined(XORSTR_ARCH_X86)
+                xor_words_sse2(dst, src, key, words);
+#endif
+            } else if constexpr (compiletime_isa == isa::neon) {
+#if defined(XORSTR_ARCH_NEON)
+                xor_words_neon(dst, src, key, words);
+#endif
+            } else {
+                xor_words_scalar(dst, src, key, words);
+            }
+        }
+
+        inline void resolve_xor_words(void *dst, const uint64_t *src, const uint64_t *key, std::size_t words) noexcept;
+
+        /**
+         * @brief 当前生效的内核。初值为解析函数，首次调用时执行一次 CPUID 检测并替换自身，
+         * 常量初始化，不依赖静态初始化顺序，也不需要加锁。
+         */
+        inline std::atomic<xor_kernel> active_kernel{&resolve_xor_words};
+
+        inline void resolve_xor_words(void *dst, const uint64_t *src, const uint64_t *key, std::size_t words) noexcept {
+            const xor_kernel kernel = kernel_for(runtime_isa());
+            active_kernel.store(kernel, std::memory_order_relaxed);
+            kernel(dst, src, key, words);
+        }
+
+        /**
+         * @brief 64 字节以内间接调用的开销大于更宽指令带来的收益，直接走编译期内核
+         */
+        inline constexpr std::size_t dispatch_threshold_words = 8;
+
+        template <std::size_t Words>
+        inline void xor_words(void *dst, const uint64_t *src, const uint64_t *key) noexcept {
+            // 绝大多数字面量不超过 16 字节：一个 GPR 或一个 XMM 即可完成，不进入循环
+            if constexpr (Words == 1) {
+                store_word(dst, 0, src[0] ^ key[0]);
+                return;
+            } else if constexpr (Words == 2) {
+#if defined(XORSTR_ARCH_X86)
+                if constexpr (compiletime_isa >= isa::sse2) {
+                    const __m128i encrypted_data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+                    const __m128i key_mask = _mm_loadu_si128(reinterpret_cast<const __m128i *>(key));
+                    _mm_storeu_si128(static_cast<__m128i *>(dst), _mm_xor_si128(encrypted_data, key_mask));
+                    return;
+                }
+#endif
+                store_word(dst, 0, src[0] ^ key[0]);
+                store_word(dst, 1, src[1] ^ key[1]);
+                return;
+            }
+#if XORSTR_RUNTIME_DISPATCH
+            if constexpr (Words > dispatch_threshold_words) {
+                active_kernel.load(std::memory_order_relaxed)(dst, src, key, Words);
+                return;
+            }
+#endif
+            xor_words_static(dst, src, key, Words);
+        }
+
+        /**
+         * @brief 非原地解密超过该大小时改用非临时存储，避免一次性写出的明文把缓存挤满
+         */
+        inline constexpr std::size_t non_temporal_threshold_bytes = std::size_t{1} << 18;
+
+#if defined(XORSTR_ARCH_X86)
+        /**
+         * @brief movntdq 流式写出。带宽受限时 128 位已经足够，因此只需要 SSE2 版本。
+         * 调用方保证 dst 8 字节对齐，最多补一个字即可到达 16 字节边界。
+         */
+        XORSTR_TARGET("sse2")
+        inline void xor_words_stream_sse2(void *dst, const uint64_t *src, const uint64_t *key,
+                                          std::size_t words) noexcept {
+            auto *out = static_cast<unsigned char *>(dst);
+            std::size_t i = 0;
+            if (words > 0 && (reinterpret_cast<std::uintptr_t>(out) & 15) != 0) {
+                store_word(dst, 0, src[0] ^ key[0]);
+                i = 1;
+            }
+            for (; i + 2 <= words; i += 2) {
+                const __m128i encrypted_data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+                const __m128i key_mask = _mm_loadu_si128(reinterpret_cast<const __m128i *>(key + i));
+                _mm_stream_si128(reinterpret_cast<__m128i *>(out + i * sizeof(uint64_t)),
+                                 _mm_xor_si128(encrypted_data, key_mask));
+            }
+            _mm_sfence();
+            if (i < words) {
+                store_word(dst, i, src[i] ^ key[i]);
+            }
+        }
+#endif
+
+        /**
+         * @brief 非原地解密：大块数据走非临时存储，其余与 xor_words 相同
+         */
+        template <std::size_t Words>
+        inline void xor_words_out(void *dst, const uint64_t *src, const uint64_t *key) noexcept {
+#if defined(XORSTR_ARCH_X86)
+            if constexpr (Words * sizeof(uint64_t) >= non_temporal_threshold_bytes) {
+                if ((reinterpret_cast<std::uintptr_t>(dst) & 7) == 0) {
+                    xor_words_stream_sse2(dst, src, key, Words);
+                    return;
+                }
+            }
+#endif
+            xor_words<Words>(dst, src, key);
+        }
+
+        /**
+         * @brief 阻止编译器看穿种子或密钥表地址。否则密文与密钥都是编译期常量，
+         * 优化器会直接把明文折叠成立即数，或把展开的密钥重新合并成 .rodata 常量。
+         */
+        template <typename T> [[nodiscard]] inline T opaque(T value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+            __asm__("" : "+r"(value));
+#else
+            volatile T sink = value;
+            value = sink;
+#endif
+            return value;
+        }
+
+        /**
+         * @brief 寄存器密钥流内核签名：dst[i] = src[i] ^ indexed_key_gen(seed, first + i)，按 64 位字计数
+         */
+        using keystream_kernel = void (*)(void *dst, const uint64_t *src, uint64_t seed, std::size_t first,
+                                          std::size_t words) noexcept;
+
+        inline void xor_keystream_scalar(void *dst, const uint64_t *src, uint64_t seed, std::size_t first,
+                                         std::size_t words) noexcept {
+            for (std::size_t i = 0; i < words; ++i) {
+                store_word(dst, i, src[i] ^ indexed_key_gen(seed, first + i));
+            }
+        }
+
+#if defined(XORSTR_ARCH_X86)
+        // 向量版 indexed_key_gen：每个 64 位通道独立计算一个下标的密钥。
+        // AVX2/AVX-512F 没有 64 位乘法，用三次 32x32 -> 64 的 pmuludq 拼出低 64 位；
+        // XMM 只有两个通道，拼乘法的代价抵消了并行度，因此 SSE2 直接使用标量内核。
+        XORSTR_TARGET("avx2") inline __m256i mul64_avx2(__m256i a, uint64_t c) noexcept {
+            const __m256i c_lo = _mm256_set1_epi64x(static_cast<long long>(c & 0xFFFFFFFFULL));
+            const __m256i c_hi = _mm256_set1_epi64x(static_cast<long long>(c >> 32));
+            const __m256i cross =
+                _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), c_lo), _mm256_mul_epu32(a, c_hi));
+            return _mm256_add_epi64(_mm256_mul_epu32(a, c_lo), _mm256_slli_epi64(cross, 32));
+        }
+
+        XORSTR_TARGET("avx2") inline __m256i key_gen_avx2(__m256i z) noexcept {
+            z = mul64_avx2(_mm256_xor_si256(z, _mm256_srli_epi64(z, 30)), 0xBF58476D1CE4E5B9ULL);
+            z = mul64_avx2(_mm256_xor_si256(z, _mm256_srli_epi64(z, 27)), 0x94D049BB133111EBULL);
+            z = _mm256_xor_si256(z, _mm256_srli_epi64(z, 31));
+            z = _mm256_xor_si256(z, _mm256_set1_epi64x(static_cast<long long>(0xAAAAAAAAAAAAAAAAULL)));
+            return mul64_avx2(z, 0xC6FD031E56F1449DULL);
+        }
+
+        // 移位与 pmuludq 使用全选掩码的 maskz 形式：GCC 的无掩码形式以自初始化的 _mm512_undefined_epi32()
+        // 作直通操作数，内联进用户代码后会产生大量 -Wmaybe-uninitialized 误报。全选掩码生成的指令相同
+        inline constexpr __mmask8 all_lanes_avx512 = 0xFF;
+
+        XORSTR_TARGET("avx512f") inline __m512i mul64_avx512(__m512i a, uint64_t c) noexcept {
+            const __m512i c_lo = _mm512_set1_epi64(static_cast<long long>(c & 0xFFFFFFFFULL));
+            const __m512i c_hi = _mm512_set1_epi64(static_cast<long long>(c >> 32));
+            const __m512i a_hi = _mm512_maskz_srli_epi64(all_lanes_avx512, a, 32);
+            const __m512i cross = _mm512_add_epi64(_mm512_maskz_mul_epu32(all_lanes_avx512, a_hi, c_lo),
+                                                   _mm512_maskz_mul_epu32(all_lanes_avx512, a, c_hi));
+            return _mm512_add_epi64(_mm512_maskz_mul_epu32(all_lanes_avx512, a, c_lo),
+                                    _mm512_maskz_slli_epi64(all_lanes_avx512, cross, 32));
+        }
+
+        XORSTR_TARGET("avx512f") inline __m512i key_gen_avx512(__m512i z) noexcept {
+            z = mul64_avx512(_mm512_xor_si512(z, _mm512_maskz_srli_epi64(all_lanes_avx512, z, 30)),
+                             0xBF58476D1CE4E5B9ULL);
+            z = mul64_avx512(_mm512_xor_si512(z, _mm512_maskz_srli_epi64(all_lanes_avx512, z, 27)),
+                             0x94D049BB133111EBULL);
+            z = _mm512_xor_si512(z, _mm512_maskz_srli_epi64(all_lanes_avx512, z, 31));
+            z = _mm512_xor_si512(z, _mm512_set1_epi64(static_cast<long long>(0xAAAAAAAAAAAAAAAAULL)));
+            return mul64_avx512(z, 0xC6FD031E56F1449DULL);
+        }
+
+        /**
+         * @brief 一个 YMM 同时展开 4 个下标的密钥
+         */
+        XORSTR_TARGET("avx2")
+        inline void xor_keystream_avx2(void *dst, const uint64_t *src, uint64_t seed, std::size_t first,
+                                       std::size_t words) noexcept {
+            auto *out = static_cast<unsigned char *>(dst);
+            __m256i index = _mm256_add_epi64(_mm256_set1_epi64x(static_cast<long long>(seed + first)),
+                                             _mm256_set_epi64x(3, 2, 1, 0));
+            const __m256i step = _mm256_set1_epi64x(4);
+            std::size_t i = 0;
+            for (; i + 4 <= words; i += 4) {
+                const __m256i encrypted_data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i * sizeof(uint64_t)),
+                                    _mm256_xor_si256(encrypted_data, key_gen_avx2(index)));
+                index = _mm256_add_epi64(index, step);
+            }
+            for (; i < words; ++i) {
+                store_word(dst, i, src[i] ^ indexed_key_gen(seed, first + i));
+            }
+        }
+
+        XORSTR_TARGET("avx512f")
+        inline void xor_keystream_avx512(void *dst, const uint64_t *src, uint64_t seed, std::size_t first,
+                                         std::size_t words) noexcept {
+            auto *out = static_cast<unsigned char *>(dst);
+            __m512i index = _mm512_add_epi64(_mm512_set1_epi64(static_cast<long long>(seed + first)),
+                                             _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0));
+            const __m512i step = _mm512_set1_epi64(8);
+            std::size_t i = 0;
+            for (; i + 8 <= words; i += 8) {
+                const __m512i encrypted_data = _mm512_loadu_si512(src + i);
+                _mm512_storeu_si512(out + i * sizeof(uint64_t),
+                                    _mm512_xor_si512(encrypted_data, key_gen_avx512(index)));
+                index = _mm512_add_epi64(index, step);
+            }
+            if (i < words) {
+                const __mmask8 tail = static_cast<__mmask8>((1u << (words - i)) - 1);
+                const __m512i encrypted_data = _mm512_maskz_loadu_epi64(tail, src + i);
+                _mm512_mask_storeu_epi64(out + i * sizeof(uint64_t), tail,
+                                         _mm512_xor_si512(encrypted_data, key_gen_avx512(index)));
+            }
+        }
+#endif
+
+        [[nodiscard]] inline keystream_kernel keystream_kernel_for(isa level) noexcept {
+            switch (level) {
+#if defined(XORSTR_ARCH_X86)
+            case isa::avx2:
+                return &xor_keystream_avx2;
+            case isa::avx512:
+                return &xor_keystream_avx512;
+#endif
+            default:
+                // SSE2 与 NEON 的 64 位向量乘法都需要拼接，不如标量 mul
+                return &xor_keystream_scalar;
+            }
+        }
+
+        /**
+         * @brief 编译期选择的寄存器密钥流内核，直接调用以便内联
+         */
+        inline void xor_keystream_static(void *dst, const uint64_t *src, uint64_t seed, std::size_t first,
+                                         std::size_t words) noexcept {
+#if defined(XORSTR_ARCH_X86)
+            if constexpr (compiletime_isa == isa::avx512) {
+                xor_keystream_avx512(dst, src, seed, first, words);
+            } else if constexpr (compiletime_isa == isa::avx2) {
+                xor_keystream_avx2(dst, src, seed, first, words);
+            } else {
+                xor_keystream_scalar(dst, src, seed, first, words);
+            }
+#else
+            xor_keystream_scalar(dst, src, seed, first, words);
+#endif
+        }
+
+        inline void resolve_xor_keystream(void *dst, const uint64_t *src, uint64_t seed, std::size_t first,
+                                          std::size_t words) noexcept;
+
+        /**
+         * @brief 当前生效的寄存器密钥流内核，与 active_kernel 一样在首次调用时解析
+         */
+        inline std::atomic<keystream_kernel> active_keystream_kernel{&resolve_xor_keystream};
+
+        inline void resolve_xor_keystream(void *dst, const uint64_t *src, uint64_t seed, std::size_t first,
+                                          std::size_t words) noexcept {
+            const keystream_kernel kernel = keystream_kernel_for(runtime_isa());
+            active_keystream_kernel.store(kernel, std::memory_order_relaxed);
+            kernel(dst, src, seed, first, words);
+        }
 
-        for (size_t i = 0; i < sizeof(uint64_t) / sizeof(CharT); i += 1) {
-            size_t idx = offset + i;
-            if (idx < total_bytes) {
-                // i * sizeof(CharT)为了支持char和wchar
-                value |= static_cast<uint64_t>(str[idx]) << (i * sizeof(CharT) * 8); // little-endian
+        /**
+         * @brief 运行期字数的寄存器密钥流异或：短数据内联标量展开，长数据交给向量内核，每次展开多个下标
+         */
+        inline void xor_keystream_n(void *dst, const uint64_t *src, uint64_t seed, std::size_t first,
+                                    std::size_t words) noexcept {
+            if (words <= dispatch_threshold_words) {
+                xor_keystream_scalar(dst, src, seed, first, words);
+                return;
             }
+#if XORSTR_RUNTIME_DISPATCH
+            active_keystream_kernel.load(std::memory_order_relaxed)(dst, src, seed, first, words);
+#else
+            xor_keystream_static(dst, src, seed, first, words);
+#endif
         }
 
-        return value ^ key;
+        /**
+         * @brief 以 indexed_key_gen(seed, i) 为密钥流异或，密钥只存在于寄存器中，
+         * 解密只访问密文所在的缓存行
+         */
+        template <std::size_t Words>
+        inline void xor_keystream(void *dst, const uint64_t *src, uint64_t seed) noexcept {
+            seed = opaque(seed);
+            if constexpr (Words <= dispatch_threshold_words) {
+                xor_keystream_scalar(dst, src, seed, 0, Words);
+            } else {
+                xor_keystream_n(dst, src, seed, 0, Words);
+            }
+        }
+
+        /**
+         * @brief 运行期字数的表密钥异或，超过阈值时走运行期分派的内核
+         */
+        inline void xor_words_n(void *dst, const uint64_t *src, const uint64_t *key, std::size_t words) noexcept {
+#if XORSTR_RUNTIME_DISPATCH
+            if (words > dispatch_threshold_words) {
+                active_kernel.load(std::memory_order_relaxed)(dst, src, key, words);
+                return;
+            }
+#endif
+            xor_words_static(dst, src, key, words);
+        }
+
+        /**
+         * @brief .rodata 密钥表：第 i 个字的密钥为 keys[i]
+         */
+        struct table_keystream {
+            const uint64_t *keys;
+
+            [[nodiscard]] uint64_t at(std::size_t index) const noexcept { return keys[index]; }
+
+            void apply(void *dst, const uint64_t *src, std::size_t first, std::size_t words) const noexcept {
+#if defined(XORSTR_ARCH_X86)
+                if (words * sizeof(uint64_t) >= non_temporal_threshold_bytes && dst != src &&
+                    (reinterpret_cast<std::uintptr_t>(dst) & 7) == 0) {
+                    xor_words_stream_sse2(dst, src, keys + first, words);
+                    return;
+                }
+#endif
+                xor_words_n(dst, src, keys + first, words);
+            }
+        };
+
+        /**
+         * @brief 寄存器密钥流：第 i 个字的密钥为 indexed_key_gen(seed, i)，可按下标随机访问
+         */
+        struct seed_keystream {
+            uint64_t seed;
+
+            [[nodiscard]] uint64_t at(std::size_t index) const noexcept { return indexed_key_gen(seed, index); }
+
+            void apply(void *dst, const uint64_t *src, std::size_t first, std::size_t words) const noexcept {
+                xor_keystream_n(dst, src, seed, first, words);
+            }
+        };
+
+        /**
+         * @brief 全零密钥流，用于已经原地解密的数据
+         */
+        struct zero_keystream {
+            [[nodiscard]] uint64_t at(std::size_t) const noexcept { return 0; }
+
+            void apply(void *dst, const uint64_t *src, std::size_t, std::size_t words) const noexcept {
+                std::memmove(dst, src, words * sizeof(uint64_t));
+            }
+        };
+
+        /**
+         * @brief 解密密文中任意字节区间 [offset, offset + bytes) 到 dst。
+         * 首尾不完整的字在寄存器中解密后只拷贝需要的字节，中间的完整字交给密钥流批量处理。
+         * @param src 整段密文的起始地址（第 0 个字）
+         */
+        template <typename Keystream>
+        inline void xor_byte_range(void *dst, const uint64_t *src, std::size_t offset, std::size_t bytes,
+                                   const Keystream &keys) noexcept {
+            auto *out = static_cast<unsigned char *>(dst);
+            std::size_t word = offset / sizeof(uint64_t);
+            const std::size_t skip = offset % sizeof(uint64_t);
+            if (skip != 0 && bytes > 0) {
+                const uint64_t plain = src[word] ^ keys.at(word);
+                const std::size_t take = bytes < sizeof(uint64_t) - skip ? bytes : sizeof(uint64_t) - skip;
+                std::memcpy(out, reinterpret_cast<const unsigned char *>(&plain) + skip, take);
+                out += take;
+                bytes -= take;
+                ++word;
+            }
+            const std::size_t full_words = bytes / sizeof(uint64_t);
+            if (full_words > 0) {
+                keys.apply(out, src + word, word, full_words);
+                out += full_words * sizeof(uint64_t);
+                bytes -= full_words * sizeof(uint64_t);
+                word += full_words;
+            }
+            if (bytes > 0) {
+                const uint64_t plain = src[word] ^ keys.at(word);
+                std::memcpy(out, &plain, bytes);
+            }
+        }
+
+        /**
+         * @brief 输入与密文中字节区间 [offset, offset + bytes) 的明文之间的差异（按位或），为 0 表示相同。
+         * 逐字在寄存器中比较并屏蔽区间外的字节，不提前退出，也不把明文写入内存。
+         */
+        template <typename Keystream>
+        inline uint64_t diff_byte_range(const void *input, const uint64_t *cipher, std::size_t offset,
+                                        std::size_t bytes, const Keystream &keys) noexcept {
+            const auto *in = static_cast<const unsigned char *>(input);
+            std::size_t word = offset / sizeof(uint64_t);
+            std::size_t skip = offset % sizeof(uint64_t);
+            uint64_t diff = 0;
+            while (bytes > 0) {
+                const std::size_t take = bytes < sizeof(uint64_t) - skip ? bytes : sizeof(uint64_t) - skip;
+                uint64_t value = 0;
+                uint64_t mask = 0;
+                std::memcpy(reinterpret_cast<unsigned char *>(&value) + skip, in, take);
+                std::memset(reinterpret_cast<unsigned char *>(&mask) + skip, 0xFF, take);
+                diff |= (value ^ cipher[word] ^ keys.at(word)) & mask;
+                in += take;
+                bytes -= take;
+                skip = 0;
+                ++word;
+            }
+            return diff;
+        }
+
+        /**
+         * @brief 把输入按密钥流加密后与密文逐字异或，所有差异按位或到一起返回。
+         * 不提前退出，耗时只取决于字数；输入无需对齐。
+         */
+        inline uint64_t diff_words(const void *input, const uint64_t *cipher, const uint64_t *key,
+                                   std::size_t words) noexcept {
+            uint64_t diff = 0;
+            std::size_t i = 0;
+#if defined(XORSTR_ARCH_X86)
+            if constexpr (compiletime_isa >= isa::sse2) {
+                if (words >= 2) {
+                    __m128i acc = _mm_setzero_si128();
+                    for (; i + 2 <= words; i += 2) {
+                        const __m128i plain = _mm_loadu_si128(
+                            reinterpret_cast<const __m128i *>(static_cast<const unsigned char *>(input) + i * 8));
+                        const __m128i key_mask = _mm_loadu_si128(reinterpret_cast<const __m128i *>(key + i));
+                        const __m128i encrypted_data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cipher + i));
+                        acc = _mm_or_si128(acc, _mm_xor_si128(_mm_xor_si128(plain, key_mask), encrypted_data));
+                    }
+                    alignas(16) uint64_t lanes[2];
+                    _mm_store_si128(reinterpret_cast<__m128i *>(lanes), acc);
+                    diff = lanes[0] | lanes[1];
+                }
+            }
+#endif
+            for (; i < words; ++i) {
+                diff |= load_word(input, i) ^ key[i] ^ cipher[i];
+            }
+            return diff;
+        }
+
+#if !defined(__GNUC__) && !defined(__clang__)
+        inline void retain_sink(const void *) noexcept {}
+
+        // 经由 volatile 函数指针调用，编译器无法证明被调用者不读取这段内存
+        inline void (*const volatile retain_fn)(const void *) noexcept = &retain_sink;
+#endif
+
+        /**
+         * @brief 编译器屏障：此前对 data 的写入必须真正落到内存，不能被当作死存储删除。
+         * 不产生任何指令（GCC/Clang），或只有一次间接调用（其他编译器）。
+         */
+        inline void retain(const void *data) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+            __asm__ __volatile__("" : : "r"(data) : "memory");
+#else
+            retain_fn(data);
+#endif
+        }
+
+        /**
+         * @brief 不会被死存储消除的清零，用于销毁明文。
+         * 使用普通的 memset（由编译器展开成向量存储），再用屏障阻止消除，而不是逐字节的 volatile 写。
+         */
+        inline void secure_wipe(void *data, std::size_t bytes) noexcept {
+            std::memset(data, 0, bytes);
+            retain(data);
+        }
+    } // namespace detail
+
+    /**
+     * @brief 支持加密的字符类型
+     */
+    template <typename CharT>
+    concept xorstr_char = std::same_as<CharT, char> || std::same_as<CharT, wchar_t> || std::same_as<CharT, char8_t> ||
+                          std::same_as<CharT, char16_t> || std::same_as<CharT, char32_t>;
+
+    /**
+     * @brief 把整个字面量按内存布局打包成 64 位字，末尾补零。
+     * 通过 std::bit_cast 整体转换，与运行期 reinterpret_cast 看到的字节完全一致（与字节序无关）。
+     */
+    template <size_t Words, xorstr_char CharT, size_t N>
+    constexpr std::array<uint64_t, Words> pack_blocks(const CharT (&str)[N]) {
+        static_assert(sizeof(uint64_t) % sizeof(CharT) == 0);
+        static_assert(sizeof(CharT) * N <= sizeof(uint64_t) * Words);
+        std::array<CharT, Words * sizeof(uint64_t) / sizeof(CharT)> chars{};
+        for (size_t i = 0; i < N; ++i) {
+            chars[i] = str[i];
+        }
+        return std::bit_cast<std::array<uint64_t, Words>>(chars);
+    }
+
+    /**
+     * @brief 默认密钥流策略：第 i 个字的密钥为 indexed_key_gen(seed, i)，
+     * xorstr 对它使用专门的快速路径（.rodata 密钥表，或 XORSTR_REGISTER_KEYS 下的寄存器展开）。
+     *
+     * 自定义策略需要提供以下静态成员：
+     *   keys<Words>(seed)                     编译期生成前 Words 个字的密钥，用于加密
+     *   word(seed, index)                     运行期第 index 个字的密钥
+     *   apply(dst, src, seed, offset, bytes)  运行期 dst[j] = src[j] ^ 密钥流第 offset + j 个字节（j < bytes），
+     *                                         dst 可以与 src 相同，两者都不要求对齐
+     */
+    struct splitmix_keys {
+        template <size_t Words> static constexpr std::array<uint64_t, Words> keys(uint64_t seed) {
+            std::array<uint64_t, Words> keys{};
+            for (size_t i = 0; i < Words; ++i) {
+                keys[i] = indexed_key_gen(seed, i);
+            }
+            return keys;
+        }
+
+        [[nodiscard]] static uint64_t word(uint64_t seed, size_t index) noexcept {
+            return indexed_key_gen(seed, index);
+        }
+
+        static void apply(void *dst, const void *src, uint64_t seed, size_t offset, size_t bytes) noexcept {
+            const auto *in = static_cast<const unsigned char *>(src);
+            auto *out = static_cast<unsigned char *>(dst);
+            for (size_t j = 0; j < bytes; ++j) {
+                const size_t pos = offset + j;
+                const uint64_t key = indexed_key_gen(seed, pos / sizeof(uint64_t));
+                unsigned char key_bytes[sizeof(uint64_t)];
+                std::memcpy(key_bytes, &key, sizeof(key));
+                out[j] = static_cast<unsigned char>(in[j] ^ key_bytes[pos % sizeof(uint64_t)]);
+            }
+        }
+    };
+
+#if XORSTR_ENABLE_STATS
+    /**
+     * @brief 单个调用点的统计快照
+     */
+    struct xorstr_site_stats {
+        const char *file;
+        uint32_t line;
+        uint64_t calls;
+        uint64_t bytes;
+        uint64_t cycles;
+    };
+
+    namespace detail::stats {
+        /**
+         * @brief make_xorstr 捕获的调用点位置，存放在对象中（只在统计模式下存在）
+         */
+        struct location {
+            const char *file = "<unknown>";
+            uint32_t line = 0;
+        };
+
+        // 每个调用点的计数器按线程分片，各占一条缓存行，热点调用点在多线程下也不会争用同一行
+        inline constexpr std::size_t shard_count = 16;
+
+        struct alignas(64) shard {
+            std::atomic<uint64_t> calls{0};
+            std::atomic<uint64_t> bytes{0};
+            std::atomic<uint64_t> cycles{0};
+        };
+
+        struct site {
+            std::atomic<bool> enrolled{false};
+            location where;
+            site *next = nullptr;
+            std::array<shard, shard_count> shards;
+        };
+
+        // 所有已登记调用点组成的无锁单链表，只增不删
+        inline std::atomic<site *> registry{nullptr};
+
+        inline std::atomic<std::size_t> next_shard{0};
+
+        /**
+         * @brief 每个线程首次调用时轮流分到一个分片
+         */
+        inline std::size_t shard_index() noexcept {
+            thread_local const std::size_t index = next_shard.fetch_add(1, std::memory_order_relaxed) % shard_count;
+            return index;
+        }
+
+        /**
+         * @brief 每个 xorstr 类型（即每个调用点，种子各不相同）一条记录
+         */
+        template <typename Xor> inline site site_of{};
+
+        inline void enroll(site &record, const location &where) noexcept {
+            bool expected = false;
+            if (record.enrolled.compare_exchange_strong(expected, true, std::memory_order_relaxed)) {
+                record.where = where;
+                site *head = registry.load(std::memory_order_relaxed);
+                do {
+                    record.next = head;
+                } while (!registry.compare_exchange_weak(head, &record, std::memory_order_release,
+                                                         std::memory_order_relaxed));
+            }
+        }
+
+        /**
+         * @brief x86 上为 TSC 周期，其他平台为 steady_clock 的纳秒数
+         */
+        inline uint64_t timestamp() noexcept {
+#if defined(XORSTR_ARCH_X86)
+            return __rdtsc();
+#else
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                             std::chrono::steady_clock::now().time_since_epoch())
+                                             .count());
+#endif
+        }
+
+        /**
+         * @brief 作用域计时：构造时登记调用点并读时间戳，析构时累加到当前线程的分片。bytes 为 0 时什么也不做
+         */
+        class scope {
+        public:
+            scope(site &record, const location &where, uint64_t bytes) noexcept : record(record), bytes(bytes) {
+                if (bytes != 0) {
+                    enroll(record, where);
+                    start = timestamp();
+                }
+            }
+
+            scope(const scope &) = delete;
+            scope &operator=(const scope &) = delete;
+
+            ~scope() {
+                if (bytes != 0) {
+                    const uint64_t elapsed = timestamp() - start;
+                    shard &slot = record.shards[shard_index()];
+                    slot.calls.fetch_add(1, std::memory_order_relaxed);
+                    slot.bytes.fetch_add(bytes, std::memory_order_relaxed);
+                    slot.cycles.fetch_add(elapsed, std::memory_order_relaxed);
+                }
+            }
+
+        private:
+            site &record;
+            uint64_t bytes;
+            uint64_t start = 0;
+        };
+    } // namespace detail::stats
+
+    /**
+     * @brief 所有发生过解密的调用点的计数快照，按调用次数从高到低排序
+     */
+    inline std::vector<xorstr_site_stats> xorstr_stats() {
+        std::vector<xorstr_site_stats> sites;
+        for (detail::stats::site *record = detail::stats::registry.load(std::memory_order_acquire);
+             record != nullptr; record = record->next) {
+            xorstr_site_stats entry{record->where.file, record->where.line, 0, 0, 0};
+            for (const detail::stats::shard &slot : record->shards) {
+                entry.calls += slot.calls.load(std::memory_order_relaxed);
+                entry.bytes += slot.bytes.load(std::memory_order_relaxed);
+                entry.cycles += slot.cycles.load(std::memory_order_relaxed);
+            }
+            sites.push_back(entry);
+        }
+        std::sort(sites.begin(), sites.end(),
+                  [](const xorstr_site_stats &a, const xorstr_site_stats &b) { return a.calls > b.calls; });
+        return sites;
+    }
+
+    /**
+     * @brief 计数清零，调用点登记保留
+     */
+    inline void reset_xorstr_stats() noexcept {
+        for (detail::stats::site *record = detail::stats::registry.load(std::memory_order_acquire);
+             record != nullptr; record = record->next) {
+            for (detail::stats::shard &slot : record->shards) {
+                slot.calls.store(0, std::memory_order_relaxed);
+                slot.bytes.store(0, std::memory_order_relaxed);
+                slot.cycles.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief 以文本表格输出 xorstr_stats()，便于挑出适合改用 XOR_STR_CACHED 的热点调用点
+     */
+    inline void dump_xorstr_stats(std::FILE *out = stderr) {
+        std::fprintf(out, "%12s %14s %16s %10s  %s\n", "calls", "bytes", "cycles", "cyc/call", "site");
+        for (const xorstr_site_stats &entry : xorstr_stats()) {
+            const double per_call = entry.calls == 0 ? 0.0 : static_cast<double>(entry.cycles) / entry.calls;
+            std::fprintf(out, "%12llu %14llu %16llu %10.1f  %s:%u\n", static_cast<unsigned long long>(entry.calls),
+                         static_cast<unsigned long long>(entry.bytes), static_cast<unsigned long long>(entry.cycles),
+                         per_call, entry.file, static_cast<unsigned>(entry.line));
+        }
     }
+#endif
 
-    template <typename CharT, size_t N, uint64_t... Keys> struct xorstr {
-        template <size_t... Is>
-        constexpr xorstr(const CharT (&str)[N], std::index_sequence<Is...>)
-            : encrypted_blocks{xor_block<CharT, N>(str, Is, Keys)...} {}
+    template <typename CharT, size_t N, uint64_t Seed, typename Keystream = splitmix_keys> struct xorstr;
+    template <typename CharT, uint64_t Seed, typename Keystream, size_t... Ns> class xorstr_table;
 
+    /**
+     * @brief reveal_guard 离开作用域时如何处理原地明文
+     */
+    enum class wipe_policy : uint8_t {
+        reencrypt, // 重新异或成密文，对象之后仍可再次解密
+        zero,      // 清零，对象之后读作空字符串
+    };
+
+    /**
+     * @brief 原地解密一个 xorstr 对象，离开作用域时按 Policy 重新加密或清零。
+     * 对象本身已是明文时同样在析构时处理。不可复制、不可移动。
+     */
+    template <typename Xor, wipe_policy Policy = wipe_policy::reencrypt> class reveal_guard {
+    public:
+        using value_type = typename Xor::value_type;
+
+        explicit reveal_guard(Xor &obj) noexcept : obj(obj), plain(obj.decrypt()) {}
+
+        reveal_guard(const reveal_guard &) = delete;
+        reveal_guard &operator=(const reveal_guard &) = delete;
+
+        ~reveal_guard() {
+            if constexpr (Policy == wipe_policy::reencrypt) {
+                obj.encrypt();
+                detail::retain(obj.encrypted_blocks.data());
+            } else {
+                obj.wipe();
+            }
+        }
+
+        [[nodiscard]] const value_type *data() const noexcept { return plain; }
+
+        [[nodiscard]] const value_type *c_str() const noexcept { return plain; }
+
+        [[nodiscard]] static constexpr size_t size() noexcept { return Xor::size(); }
+
+        [[nodiscard]] std::basic_string_view<value_type> view() const noexcept { return {plain, size()}; }
+
+        operator std::basic_string_view<value_type>() const noexcept { return view(); }
+
+    private:
+        Xor &obj;
+        const value_type *plain;
+    };
+
+    namespace detail {
+        struct batch;
+
+        template <typename T> inline constexpr bool is_xorstr = false;
+        template <typename CharT, size_t N, uint64_t Seed, typename Keystream>
+        inline constexpr bool is_xorstr<xorstr<CharT, N, Seed, Keystream>> = true;
+    } // namespace detail
+
+    /**
+     * @brief 持有解密明文的 RAII 句柄。明文存放在句柄自身（栈上），析构时清零。
+     * 不可复制、不可移动，明文不会被带出句柄的作用域。
+     */
+    template <typename CharT, size_t N> class revealed {
+    public:
+        using value_type = CharT;
+
+        revealed(const revealed &) = delete;
+        revealed &operator=(const revealed &) = delete;
+
+        ~revealed() { detail::secure_wipe(plain_blocks.data(), sizeof(plain_blocks)); }
+
+        [[nodiscard]] const CharT *data() const noexcept {
+            return reinterpret_cast<const CharT *>(plain_blocks.data());
+        }
+
+        [[nodiscard]] const CharT *c_str() const noexcept { return data(); }
+
+        // 不含末尾的 '\0'
+        [[nodiscard]] static constexpr size_t size() noexcept { return N - 1; }
+
+        [[nodiscard]] static constexpr size_t length() noexcept { return N - 1; }
+
+        [[nodiscard]] std::basic_string_view<CharT> view() const noexcept { return {data(), size()}; }
+
+        operator std::basic_string_view<CharT>() const noexcept { return view(); }
+
+    private:
+        template <typename, size_t, uint64_t, typename> friend struct xorstr;
+        template <typename, uint64_t, typename, size_t...> friend class xorstr_table;
+
+        template <typename Decrypt> explicit revealed(Decrypt &&decrypt) noexcept { decrypt(plain_blocks.data()); }
+
+        static constexpr size_t block_words = align_up(sizeof(CharT) * N, sizeof(uint64_t)) / sizeof(uint64_t);
+
+        alignas(detail::storage_alignment<block_words * sizeof(uint64_t)>) std::array<uint64_t, block_words>
+            plain_blocks;
+    };
+
+    namespace detail {
+        /**
+         * @brief 逐字符的惰性迭代器：只在访问到某个 64 位字时才解密该字，缓存在迭代器内部。
+         * 提前结束的算法（find、mismatch、前缀比较等）不会解密之后的字节。
+         * 非默认密钥流每次生成都要初始化（AES 需要派生密钥并展开轮密钥），按 window_words 个字的窗口解密，
+         * 初始化代价由整个窗口分摊，与 diff_prefix 分段生成密钥流的做法相同。
+         */
+        template <typename Xor> class lazy_iterator {
+            using char_type = typename Xor::value_type;
+            static constexpr std::size_t window_words =
+                Xor::default_keystream ? 1 : std::min<std::size_t>(8, Xor::block_words);
+            static constexpr std::size_t chars_per_window = window_words * sizeof(uint64_t) / sizeof(char_type);
+            static constexpr std::size_t no_window = ~std::size_t{0};
+
+        public:
+            using value_type = char_type;
+            using difference_type = std::ptrdiff_t;
+            using iterator_concept = std::forward_iterator_tag;
+
+            lazy_iterator() = default;
+
+            lazy_iterator(const Xor *obj, std::size_t index) noexcept : obj(obj), index(index) {}
+
+            lazy_iterator(const lazy_iterator &) = default;
+            lazy_iterator &operator=(const lazy_iterator &) = default;
+
+            ~lazy_iterator() { secure_wipe(chars.data(), sizeof(chars)); }
+
+            value_type operator*() const noexcept {
+                const std::size_t window = index / chars_per_window;
+                if (window != cached_window) {
+                    if constexpr (window_words == 1) {
+                        chars = std::bit_cast<std::array<char_type, chars_per_window>>(obj->plain_word(window));
+                    } else {
+                        const std::size_t first = window * window_words;
+                        obj->plain_words(chars.data(), first, std::min(window_words, Xor::block_words - first));
+                    }
+                    cached_window = window;
+                }
+                return chars[index % chars_per_window];
+            }
+
+            lazy_iterator &operator++() noexcept {
+                ++index;
+                return *this;
+            }
+
+            lazy_iterator operator++(int) noexcept {
+                lazy_iterator previous = *this;
+                ++index;
+                return previous;
+            }
+
+            friend bool operator==(const lazy_iterator &lhs, const lazy_iterator &rhs) noexcept {
+                return lhs.index == rhs.index;
+            }
+
+        private:
+            const Xor *obj = nullptr;
+            std::size_t index = 0;
+            mutable std::size_t cached_window = no_window;
+            mutable std::array<char_type, chars_per_window> chars{};
+        };
+
+        /**
+         * @brief 按 K 个字符分块的惰性迭代器，解引用得到当前块明文的视图（最后一块可能更短）。
+         * 视图指向迭代器内部的缓冲区，迭代器前进或销毁后失效。
+         */
+        template <typename Xor, std::size_t K> class chunk_iterator {
+            using char_type = typename Xor::value_type;
+            static constexpr std::size_t no_chunk = ~std::size_t{0};
+
+        public:
+            using value_type = std::basic_string_view<char_type>;
+            using difference_type = std::ptrdiff_t;
+            using iterator_concept = std::forward_iterator_tag;
+
+            chunk_iterator() = default;
+
+            chunk_iterator(const Xor *obj, std::size_t chunk) noexcept : obj(obj), chunk(chunk) {}
+
+            chunk_iterator(const chunk_iterator &) = default;
+            chunk_iterator &operator=(const chunk_iterator &) = default;
+
+            ~chunk_iterator() { secure_wipe(buffer.data(), sizeof(buffer)); }
+
+            value_type operator*() const noexcept {
+                if (chunk != cached_chunk) {
+                    cached_length = obj->read(chunk * K, std::span<char_type>(buffer));
+                    cached_chunk = chunk;
+                }
+                return {buffer.data(), cached_length};
+            }
+
+            chunk_iterator &operator++() noexcept {
+                ++chunk;
+                return *this;
+            }
+
+            chunk_iterator operator++(int) noexcept {
+                chunk_iterator previous = *this;
+                ++chunk;
+                return previous;
+            }
+
+            friend bool operator==(const chunk_iterator &lhs, const chunk_iterator &rhs) noexcept {
+                return lhs.chunk == rhs.chunk;
+            }
+
+        private:
+            const Xor *obj = nullptr;
+            std::size_t chunk = 0;
+            mutable std::size_t cached_chunk = no_chunk;
+            mutable std::size_t cached_length = 0;
+            mutable std::array<char_type, K> buffer{};
+        };
+
+        template <typename Iterator> class lazy_view : public std::ranges::view_interface<lazy_view<Iterator>> {
+        public:
+            lazy_view() = default;
+
+            lazy_view(Iterator first, Iterator last, std::size_t count) noexcept
+                : first(first), last(last), count(count) {}
+
+            [[nodiscard]] Iterator begin() const noexcept { return first; }
+
+            [[nodiscard]] Iterator end() const noexcept { return last; }
+
+            [[nodiscard]] std::size_t size() const noexcept { return count; }
+
+        private:
+            Iterator first;
+            Iterator last;
+            std::size_t count = 0;
+        };
+    } // namespace detail
+
+    /**
+     * @brief 生成前 Words 个字的密钥表
+     */
+    template <size_t Words> constexpr std::array<uint64_t, Words> make_key_blocks(uint64_t seed) {
+        return splitmix_keys::keys<Words>(seed);
+    }
+
+    namespace detail {
+        /**
+         * @brief 去重模式下按密文实例化的共享副本。相同的字面量得到相同的种子与密文，
+         * 每个翻译单元中的实例在链接时合并为一份（COMDAT）；密文不同的字面量即使哈希碰撞也不会共用
+         */
+        template <auto Blocks> inline constexpr auto shared_blocks = Blocks;
+    } // namespace detail
+
+    /**
+     * @brief 加密字符串。密钥流完全由 Seed 派生，模板参数个数与字面量长度无关。
+     * @tparam Keystream 密钥流策略，默认 splitmix_keys；例如 <fantasy/xorstr_aes.hpp> 中的 aes_ctr_keys
+     */
+    template <typename CharT, size_t N, uint64_t Seed, typename Keystream> struct xorstr {
+        static_assert(xorstr_char<CharT>, "xorstr supports char, wchar_t, char8_t, char16_t and char32_t");
+
+        using value_type = CharT;
+        using keystream_type = Keystream;
+
+        // 默认策略走表密钥 / 寄存器密钥的快速路径，其余策略统一通过策略接口
+        static constexpr bool default_keystream = std::is_same_v<Keystream, splitmix_keys>;
+
+        // 覆盖明文所需的 64 位字数，存储与密钥流都按实际长度分配，不再补齐到 32 字节
+        static constexpr size_t block_words = align_up(sizeof(CharT) * N, sizeof(uint64_t)) / sizeof(uint64_t);
+
+        // 存储对齐：短对象为 8 字节，栈上构造时调用方不需要重新对齐栈，见 XORSTR_STORAGE_ALIGNMENT
+        static constexpr size_t storage_alignment = detail::storage_alignment<block_words * sizeof(uint64_t)>;
+
+        constexpr explicit xorstr(const CharT (&str)[N]) : encrypted_blocks{pack_blocks<block_words>(str)} {
+            const auto keys = Keystream::template keys<block_words>(Seed);
+            for (size_t i = 0; i < block_words; ++i) {
+                encrypted_blocks[i] ^= keys[i];
+            }
+        }
+
+#if XORSTR_ENABLE_STATS
+        constexpr xorstr(const CharT (&str)[N], detail::stats::location where) : xorstr(str) { stats_where = where; }
+#endif
+
+        /**
+         * @brief 密文改为取自 detail::shared_blocks<Blocks> 的副本，其余状态与本对象相同。
+         * 去重模式（XORSTR_DEDUP）下由 XORSTR_ENCRYPT 调用，相同字面量的所有调用点引用同一份密文
+         */
+        template <std::array<uint64_t, block_words> Blocks> [[nodiscard]] constexpr xorstr shared() const noexcept {
+            xorstr copy = *this;
+            XORSTR_IF_CONSTEVAL {
+                copy.encrypted_blocks = detail::shared_blocks<Blocks>;
+            } else {
+                // 经 opaque 读取共享变量本身，否则优化器会把密文重新折叠成每个调用点各自的立即数 / 常量
+                std::memcpy(copy.encrypted_blocks.data(), detail::opaque(detail::shared_blocks<Blocks>.data()),
+                            sizeof(copy.encrypted_blocks));
+            }
+            return copy;
+        }
+
+        /**
+         * @brief 明文长度（字符数，不含末尾的 '\0'），编译期已知，无需对解密结果做 strlen
+         */
+        [[nodiscard]] static constexpr size_t size() noexcept { return N - 1; }
+
+        [[nodiscard]] static constexpr size_t length() noexcept { return N - 1; }
+
+        /**
+         * @brief 明文占用的字节数（不含末尾的 '\0'），方便直接 memcpy 到输出缓冲区
+         */
+        [[nodiscard]] static constexpr size_t size_bytes() noexcept { return sizeof(CharT) * (N - 1); }
+
+        /**
+         * @brief 原地异或，再次调用会重新加密
+         * @return 指向对象内部缓冲区的指针，生命周期与对象相同
+         */
         [[nodiscard]] inline const CharT *reveal() {
-            alignas(32) constexpr uint64_t key_blocks[align_up(sizeof(CharT) * N, 32) / sizeof(uint64_t)] = {
-                Keys...,
-            };
-            std::size_t block = align_up(sizeof(CharT) * N, 32) / 32;
-            for (size_t i = 0; i < block; i++) {
-                const __m256i encrypted_data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(
-                    reinterpret_cast<const uint8_t *>(encrypted_blocks.data()) + i * 32));
-                const __m256i key_mask = _mm256_loadu_si256(
-                    reinterpret_cast<const __m256i *>(reinterpret_cast<const uint8_t *>(key_blocks) + i * 32));
-                const __m256i decrypted_data = _mm256_xor_si256(encrypted_data, key_mask);
-                _mm256_storeu_si256(
-                    reinterpret_cast<__m256i *>(reinterpret_cast<uint8_t *>(encrypted_blocks.data()) + i * 32),
-                    decrypted_data);
+#if XORSTR_ENABLE_STATS
+            const detail::stats::scope stats = stats_scope(in_plaintext ? 0 : sizeof(encrypted_blocks));
+#endif
+            apply_keystream(encrypted_blocks.data(), encrypted_blocks.data());
+            in_plaintext = !in_plaintext;
+            return reinterpret_cast<const CharT *>(encrypted_blocks.data());
+        }
+
+        /**
+         * @brief 与 reveal() 相同的原地异或，返回携带编译期长度的视图
+         */
+        [[nodiscard]] inline std::basic_string_view<CharT> reveal_view() { return {reveal(), size()}; }
+
+        /**
+         * @brief 幂等解密：已是明文时只做一次分支判断，不再执行异或
+         */
+        inline const CharT *decrypt() noexcept {
+            if (!in_plaintext) {
+#if XORSTR_ENABLE_STATS
+                const detail::stats::scope stats = stats_scope(sizeof(encrypted_blocks));
+#endif
+                apply_keystream(encrypted_blocks.data(), encrypted_blocks.data());
+                in_plaintext = true;
             }
             return reinterpret_cast<const CharT *>(encrypted_blocks.data());
         }
-        alignas(32) std::array<uint64_t, align_up(sizeof(CharT) * N, 32) / sizeof(uint64_t)> encrypted_blocks{0};
+
+        /**
+         * @brief 幂等加密：已是密文时直接返回
+         */
+        inline void encrypt() noexcept {
+            if (in_plaintext) {
+                apply_keystream(encrypted_blocks.data(), encrypted_blocks.data());
+                in_plaintext = false;
+            }
+        }
+
+        [[nodiscard]] bool is_revealed() const noexcept { return in_plaintext; }
+
+        /**
+         * @brief 清零对象中的数据（无论当前是明文还是密文），之后对象读作全 '\0' 的字符串。
+         * 清零不会被编译器当作死存储删除。
+         */
+        inline void wipe() noexcept {
+            detail::secure_wipe(encrypted_blocks.data(), sizeof(encrypted_blocks));
+            in_plaintext = true;
+        }
+
+        /**
+         * @brief 原地解密并返回守卫，守卫析构时按 Policy 重新加密或清零，
+         * 且这些存储不会因对象随后不再被读取而被优化掉
+         */
+        template <wipe_policy Policy = wipe_policy::reencrypt>
+        [[nodiscard]] inline reveal_guard<xorstr, Policy> reveal_guarded() noexcept {
+            return reveal_guard<xorstr, Policy>(*this);
+        }
+
+        /**
+         * @brief 以值返回明文（含末尾的 '\0'），对象自身保持不变。
+         * 常量求值时用标量密钥流解密，可以在编译期由密文派生查找表、哈希等结构；
+         * 只让派生结果进入运行期，否则明文本身会被写进 .rodata。运行期走与 decrypt_into 相同的向量路径。
+         */
+        [[nodiscard]] constexpr std::array<CharT, N> to_array() const noexcept {
+            std::array<CharT, N> plain{};
+            XORSTR_IF_CONSTEVAL {
+                std::array<uint64_t, block_words> words = encrypted_blocks;
+                if (!in_plaintext) {
+                    const auto keys = Keystream::template keys<block_words>(Seed);
+                    for (size_t i = 0; i < block_words; ++i) {
+                        words[i] ^= keys[i];
+                    }
+                }
+                constexpr size_t padded_chars = block_words * sizeof(uint64_t) / sizeof(CharT);
+                const auto chars = std::bit_cast<std::array<CharT, padded_chars>>(words);
+                for (size_t i = 0; i < N; ++i) {
+                    plain[i] = chars[i];
+                }
+            } else {
+                decrypt_bytes<sizeof(CharT) * N>(plain.data());
+            }
+            return plain;
+        }
+
+        /**
+         * @brief 把明文（含末尾的 '\0'，共 N 个字符）写入调用方缓冲区，对象自身保持不变。
+         * 从密文读一遍、向 dst 写一遍，没有原地解密再拷贝的往返。dst 无需对齐。
+         */
+        constexpr void decrypt_into(CharT *dst) const noexcept {
+            XORSTR_IF_CONSTEVAL {
+                std::ranges::copy(to_array(), dst);
+            } else {
+                decrypt_bytes<sizeof(CharT) * N>(dst);
+            }
+        }
+
+        /**
+         * @brief 把 size() 个明文字符（不含 '\0'）直接写入输出缓冲区，例如 iovec 或环形缓冲区
+         * @return 写入的字符数；dst 放不下时不写入任何内容并返回 0
+         */
+        constexpr size_t decrypt_into(std::span<CharT> dst) const noexcept {
+            if (dst.size() < size()) {
+                return 0;
+            }
+            XORSTR_IF_CONSTEVAL {
+                const auto plain = to_array();
+                std::ranges::copy_n(plain.begin(), size(), dst.begin());
+            } else {
+                decrypt_bytes<size_bytes()>(dst.data());
+            }
+            return size();
+        }
+
+        /**
+         * @brief 解密从第 pos 个字符开始的 dst.size() 个字符（超出 size() 的部分截断），对象自身保持不变
+         * @return 写入的字符数，pos 越界时为 0
+         */
+        inline size_t read(size_t pos, std::span<CharT> dst) const noexcept {
+            if (pos >= size()) {
+                return 0;
+            }
+            const size_t count = std::min(dst.size(), size() - pos);
+            const size_t offset = pos * sizeof(CharT);
+#if XORSTR_ENABLE_STATS
+            const detail::stats::scope stats = stats_scope(in_plaintext ? 0 : count * sizeof(CharT));
+#endif
+            if (in_plaintext) {
+                std::memcpy(dst.data(), reinterpret_cast<const unsigned char *>(encrypted_blocks.data()) + offset,
+                            count * sizeof(CharT));
+            } else if constexpr (!default_keystream) {
+                Keystream::apply(dst.data(), reinterpret_cast<const unsigned char *>(encrypted_blocks.data()) + offset,
+                                 detail::opaque(Seed), offset, count * sizeof(CharT));
+            } else if constexpr (XORSTR_REGISTER_KEYS) {
+                detail::xor_byte_range(dst.data(), encrypted_blocks.data(), offset, count * sizeof(CharT),
+                                       detail::seed_keystream{detail::opaque(Seed)});
+            } else {
+                detail::xor_byte_range(dst.data(), encrypted_blocks.data(), offset, count * sizeof(CharT),
+                                       detail::table_keystream{detail::opaque(key_blocks.data())});
+            }
+            return count;
+        }
+
+        /**
+         * @brief 与明文做常数时间比较：把输入按密钥流加密后与密文比较，不生成明文。
+         * 长度不同直接返回 false（长度本就是编译期公开的），长度相同时耗时与内容无关。
+         */
+        [[nodiscard]] constexpr bool equals(std::basic_string_view<CharT> input) const noexcept {
+            return input.size() == size() && diff_prefix(input.data(), size_bytes()) == 0;
+        }
+
+        /**
+         * @brief 明文是否以 prefix 开头，常数时间（仅与 prefix 的长度有关）
+         */
+        [[nodiscard]] constexpr bool starts_with(std::basic_string_view<CharT> prefix) const noexcept {
+            return prefix.size() <= size() && diff_prefix(prefix.data(), prefix.size() * sizeof(CharT)) == 0;
+        }
+
+        /**
+         * @brief input 是否以明文开头，例如检查请求头是否带有固定的密钥前缀，常数时间
+         */
+        [[nodiscard]] constexpr bool is_prefix_of(std::basic_string_view<CharT> input) const noexcept {
+            return input.size() >= size() && diff_prefix(input.data(), size_bytes()) == 0;
+        }
+
+        /**
+         * @brief 逐字符的惰性视图，每次只解密一个 64 位字，可直接用于 std::ranges 算法。
+         * 视图引用本对象，不能比对象活得更久。
+         */
+        [[nodiscard]] inline auto lazy() const noexcept {
+            using iterator = detail::lazy_iterator<xorstr>;
+            return detail::lazy_view<iterator>(iterator(this, 0), iterator(this, size()), size());
+        }
+
+        /**
+         * @brief 按 K 个字符分块的惰性视图，元素为当前块明文的 std::basic_string_view
+         */
+        template <size_t K> [[nodiscard]] inline auto chunks() const noexcept {
+            static_assert(K > 0, "chunk size must be positive");
+            using iterator = detail::chunk_iterator<xorstr, K>;
+            const size_t count = (size() + K - 1) / K;
+            return detail::lazy_view<iterator>(iterator(this, 0), iterator(this, count), count);
+        }
+
+        /**
+         * @brief 第 index 个 64 位字的明文
+         */
+        [[nodiscard]] inline uint64_t plain_word(size_t index) const noexcept {
+            return in_plaintext ? encrypted_blocks[index] : encrypted_blocks[index] ^ key_at(index);
+        }
+
+        /**
+         * @brief 从第 first 个字开始的 words 个 64 位字的明文写入 dst（不要求对齐），密钥流只初始化一次
+         */
+        inline void plain_words(void *dst, size_t first, size_t words) const noexcept {
+            if (in_plaintext) {
+                std::memcpy(dst, encrypted_blocks.data() + first, words * sizeof(uint64_t));
+            } else if constexpr (!default_keystream) {
+                Keystream::apply(dst, encrypted_blocks.data() + first, detail::opaque(Seed), first * sizeof(uint64_t),
+                                 words * sizeof(uint64_t));
+            } else {
+                for (size_t i = 0; i < words; ++i) {
+                    detail::store_word(dst, i, plain_word(first + i));
+                }
+            }
+        }
+
+        /**
+         * @brief 把明文逐字输出到任意输出迭代器（std::back_inserter、std::format_to / fmt 的输出迭代器等）。
+         * 连续迭代器直接写入目标内存，其余迭代器每次在寄存器中解密一个 64 位字，不产生中间缓冲区。
+         */
+        template <std::output_iterator<CharT> Out> inline Out decrypt_to(Out out) const {
+            if constexpr (std::contiguous_iterator<Out>) {
+                decrypt_bytes<size_bytes()>(std::to_address(out));
+                return out + static_cast<std::iter_difference_t<Out>>(size());
+            } else {
+                constexpr size_t chars_per_word = sizeof(uint64_t) / sizeof(CharT);
+                size_t remaining = size();
+                for (size_t i = 0; i < block_words && remaining > 0; ++i) {
+                    const auto chars = std::bit_cast<std::array<CharT, chars_per_word>>(plain_word(i));
+                    for (size_t j = 0; j < chars_per_word && remaining > 0; ++j, --remaining) {
+                        *out = chars[j];
+                        ++out;
+                    }
+                }
+                return out;
+            }
+        }
+
+        /**
+         * @brief 追加到字符串末尾：只扩容一次，随后直接解密进字符串自己的缓冲区
+         */
+        template <typename Traits, typename Alloc>
+        inline void append_to(std::basic_string<CharT, Traits, Alloc> &str) const {
+            const size_t offset = str.size();
+#if defined(__cpp_lib_string_resize_and_overwrite)
+            str.resize_and_overwrite(offset + size(), [this, offset](CharT *buffer, size_t) {
+                decrypt_bytes<size_bytes()>(buffer + offset);
+                return offset + size();
+            });
+#else
+            str.resize(offset + size());
+            decrypt_bytes<size_bytes()>(str.data() + offset);
+#endif
+        }
+
+        /**
+         * @brief 将明文解密到返回的句柄中，对象自身保持不变
+         */
+        [[nodiscard]] inline revealed<CharT, N> reveal_scoped() const {
+#if XORSTR_ENABLE_STATS
+            const detail::stats::scope stats = stats_scope(in_plaintext ? 0 : sizeof(encrypted_blocks));
+#endif
+            return revealed<CharT, N>([this](uint64_t *plain) {
+                if (in_plaintext) {
+                    std::memcpy(plain, encrypted_blocks.data(), sizeof(encrypted_blocks));
+                } else {
+                    apply_keystream(plain, encrypted_blocks.data());
+                }
+            });
+        }
+
+        /**
+         * @brief dst = src ^ 密钥流（前 Words 个字），dst 可以与 src 相同，也可以不对齐
+         */
+        template <size_t Words = block_words>
+        static inline void apply_keystream(void *dst, const uint64_t *src) noexcept {
+            static_assert(Words <= block_words);
+            if constexpr (!default_keystream) {
+                Keystream::apply(dst, src, detail::opaque(Seed), 0, Words * sizeof(uint64_t));
+            } else if constexpr (XORSTR_REGISTER_KEYS) {
+                detail::xor_keystream<Words>(dst, src, Seed);
+            } else {
+                detail::xor_words<Words>(dst, src, detail::opaque(key_blocks.data()));
+            }
+        }
+
+        /**
+         * @brief 第 index 个字的密钥
+         */
+        [[nodiscard]] static inline uint64_t key_at(size_t index) noexcept {
+            if constexpr (!default_keystream) {
+                return Keystream::word(detail::opaque(Seed), index);
+            } else if constexpr (XORSTR_REGISTER_KEYS) {
+                return indexed_key_gen(detail::opaque(Seed), index);
+            } else {
+                return detail::opaque(key_blocks.data())[index];
+            }
+        }
+
+        // 只有表模式会 odr-use，寄存器模式下不会出现在 .rodata 中
+        alignas(storage_alignment) static constexpr std::array<uint64_t, block_words> key_blocks =
+            make_key_blocks<block_words>(Seed);
+
+        alignas(storage_alignment) std::array<uint64_t, block_words> encrypted_blocks{0};
+
+    private:
+        friend struct detail::batch;
+
+        /**
+         * @brief 把明文的前 Bytes 个字节写入 dst（不要求对齐），不多写一个字节
+         */
+        template <size_t Bytes> inline void decrypt_bytes(void *dst) const noexcept {
+            static_assert(Bytes <= sizeof(CharT) * N);
+            constexpr size_t full_words = Bytes / sizeof(uint64_t);
+            if (in_plaintext) {
+                std::memcpy(dst, encrypted_blocks.data(), Bytes);
+                return;
+            }
+#if XORSTR_ENABLE_STATS
+            const detail::stats::scope stats = stats_scope(Bytes);
+#endif
+            if constexpr (!default_keystream) {
+                Keystream::apply(dst, encrypted_blocks.data(), detail::opaque(Seed), 0, Bytes);
+                return;
+            }
+            if constexpr (full_words > 0) {
+                if constexpr (XORSTR_REGISTER_KEYS) {
+                    detail::xor_keystream<full_words>(dst, encrypted_blocks.data(), Seed);
+                } else {
+                    detail::xor_words_out<full_words>(dst, encrypted_blocks.data(), detail::opaque(key_blocks.data()));
+                }
+            }
+            if constexpr (Bytes % sizeof(uint64_t) != 0) {
+                // 最后一个不完整的字在寄存器中解密，只写出需要的字节
+                const uint64_t last = encrypted_blocks[full_words] ^ key_at(full_words);
+                std::memcpy(static_cast<unsigned char *>(dst) + full_words * sizeof(uint64_t), &last,
+                            Bytes % sizeof(uint64_t));
+            }
+        }
+
+        /**
+         * @brief input 的前 bytes 个字节与明文的差异（按位或），为 0 表示相同
+         */
+        constexpr uint64_t diff_prefix(const CharT *input, size_t bytes) const noexcept {
+            XORSTR_IF_CONSTEVAL {
+                const auto plain = to_array();
+                uint64_t diff = 0;
+                for (size_t i = 0; i < bytes / sizeof(CharT); ++i) {
+                    diff |= static_cast<uint64_t>(plain[i] != input[i]);
+                }
+                return diff;
+            }
+            const size_t full_words = bytes / sizeof(uint64_t);
+            const size_t tail = bytes % sizeof(uint64_t);
+            uint64_t diff = 0;
+            if (in_plaintext || (XORSTR_REGISTER_KEYS && default_keystream)) {
+                for (size_t i = 0; i < full_words; ++i) {
+                    diff |= detail::load_word(input, i) ^ plain_word(i);
+                }
+            } else if constexpr (!default_keystream) {
+                // 分段生成密钥流（作用于全零输入），只有密钥流落在栈上，明文不会写入内存
+                constexpr size_t chunk_words = 32;
+                constexpr std::array<uint64_t, chunk_words> zeros{};
+                std::array<uint64_t, chunk_words> keys;
+                for (size_t first = 0; first < full_words; first += chunk_words) {
+                    const size_t words = std::min(chunk_words, full_words - first);
+                    Keystream::apply(keys.data(), zeros.data(), detail::opaque(Seed), first * sizeof(uint64_t),
+                                     words * sizeof(uint64_t));
+                    for (size_t i = 0; i < words; ++i) {
+                        diff |= detail::load_word(input, first + i) ^ keys[i] ^ encrypted_blocks[first + i];
+                    }
+                }
+                detail::secure_wipe(keys.data(), sizeof(keys));
+            } else {
+                diff = detail::diff_words(input, encrypted_blocks.data(), detail::opaque(key_blocks.data()),
+                                          full_words);
+            }
+            if (tail != 0) {
+                uint64_t last = 0;
+                std::memcpy(&last, reinterpret_cast<const unsigned char *>(input) + full_words * sizeof(uint64_t),
+                            tail);
+                uint64_t mask = 0;
+                std::memset(&mask, 0xFF, tail);
+                diff |= (last ^ plain_word(full_words)) & mask;
+            }
+            return diff;
+        }
+
+        // 当前 encrypted_blocks 中是否为明文
+        bool in_plaintext = false;
+
+#if XORSTR_ENABLE_STATS
+        [[nodiscard]] detail::stats::scope stats_scope(uint64_t bytes) const noexcept {
+            return detail::stats::scope(detail::stats::site_of<xorstr>, stats_where, bytes);
+        }
+
+        // 调用点位置，由 make_xorstr 捕获
+        detail::stats::location stats_where{};
+#endif
+    };
+
+#if XORSTR_ENABLE_STATS
+    template <uint64_t Seed, typename Keystream = splitmix_keys, typename CharT, size_t N>
+    constexpr auto make_xorstr(const CharT (&str)[N], std::source_location where = std::source_location::current()) {
+        return xorstr<CharT, N, Seed, Keystream>(str, {where.file_name(), static_cast<uint32_t>(where.line())});
+    }
+#else
+    template <uint64_t Seed, typename Keystream = splitmix_keys, typename CharT, size_t N>
+    constexpr auto make_xorstr(const CharT (&str)[N]) {
+        return xorstr<CharT, N, Seed, Keystream>(str);
+    }
+#endif
+
+    /**
+     * @brief 明文的 64 位 FNV-1a 哈希，按代码单元而不是按字节混合，编译期与运行期结果一致。
+     * 用于按哈希分派加密字面量（switch / 哈希表），查找路径上不需要解密任何候选项。
+     * 注意：哈希常量会出现在二进制中，低熵字符串可以被字典枚举，命中后请再用 equals() 确认。
+     */
+    template <xorstr_char CharT>
+    [[nodiscard]] constexpr uint64_t xorstr_hash(std::basic_string_view<CharT> str) noexcept {
+        uint64_t hash = 0xCBF29CE484222325ULL;
+        for (const CharT c : str) {
+            hash ^= static_cast<std::make_unsigned_t<CharT>>(c);
+            hash *= 0x100000001B3ULL;
+        }
+        return hash;
+    }
+
+    /**
+     * @brief 与 xorstr_hash 一致的运行期哈希函数对象，支持异构查找（std::string、字符串视图、C 字符串）
+     */
+    template <xorstr_char CharT = char> struct xorstr_hasher {
+        using is_transparent = void;
+
+        [[nodiscard]] std::size_t operator()(std::basic_string_view<CharT> str) const noexcept {
+            return static_cast<std::size_t>(xorstr_hash(str));
+        }
     };
 
-    template <uint64_t Seed, typename CharT, size_t N> constexpr auto make_xorstr(const CharT (&str)[N]) {
-        static constexpr uint64_t INITIAL_SEED = Seed;
-        return [&]<std::size_t... Is>(std::index_sequence<Is...>) {
-            return xorstr<CharT, N, indexed_key_gen(INITIAL_SEED, Is)...>(
-                str, std::make_index_sequence<align_up(sizeof(CharT) * N, sizeof(uint64_t)) / sizeof(uint64_t)>());
-        }(std::make_index_sequence<align_up(sizeof(CharT) * N, sizeof(uint64_t)) / sizeof(uint64_t)>{});
+    namespace detail {
+        /**
+         * @brief 批量解密/加密的实现，集中处理循环准备与密钥流加载
+         */
+        struct batch {
+            // 寄存器模式下为整批对象展开一次密钥流，超过该大小时退回逐个处理，避免占用过多栈空间
+            static constexpr std::size_t max_expanded_key_bytes = 4096;
+
+            /**
+             * @brief 把对象切换到 Plain 指定的状态，已处于该状态时不做任何事
+             */
+            template <bool Plain, typename Xor> static inline void toggle(Xor &obj) noexcept {
+                if (obj.in_plaintext != Plain) {
+                    Xor::apply_keystream(obj.encrypted_blocks.data(), obj.encrypted_blocks.data());
+                    obj.in_plaintext = Plain;
+                }
+            }
+
+            /**
+             * @brief 同类型对象共享同一条密钥流：密钥只加载（或展开）一次，
+             * 内核函数指针也只读取一次，随后每个对象只剩下异或本身
+             */
+            template <bool Plain, typename Range> static inline void toggle_range(Range &&objs) noexcept {
+                using xor_type = std::ranges::range_value_t<Range>;
+                constexpr std::size_t words = xor_type::block_words;
+                if constexpr (!xor_type::default_keystream) {
+                    for (xor_type &obj : objs) {
+                        toggle<Plain>(obj);
+                    }
+                } else if constexpr (words <= dispatch_threshold_words ||
+                              (XORSTR_REGISTER_KEYS && words * sizeof(uint64_t) <= max_expanded_key_bytes)) {
+                    std::array<uint64_t, words> keys;
+                    for (std::size_t i = 0; i < words; ++i) {
+                        keys[i] = xor_type::key_at(i);
+                    }
+                    for (xor_type &obj : objs) {
+                        if (obj.in_plaintext != Plain) {
+                            xor_words<words>(obj.encrypted_blocks.data(), obj.encrypted_blocks.data(), keys.data());
+                            obj.in_plaintext = Plain;
+                        }
+                    }
+                    secure_wipe(keys.data(), sizeof(keys));
+                } else if constexpr (XORSTR_REGISTER_KEYS) {
+                    for (xor_type &obj : objs) {
+                        toggle<Plain>(obj);
+                    }
+                } else {
+#if XORSTR_RUNTIME_DISPATCH
+                    const xor_kernel kernel = active_kernel.load(std::memory_order_relaxed);
+#else
+                    const xor_kernel kernel = &xor_words_static;
+#endif
+                    const uint64_t *keys = opaque(xor_type::key_blocks.data());
+                    for (xor_type &obj : objs) {
+                        if (obj.in_plaintext != Plain) {
+                            kernel(obj.encrypted_blocks.data(), obj.encrypted_blocks.data(), keys, words);
+                            obj.in_plaintext = Plain;
+                        }
+                    }
+                }
+            }
+        };
+
+        template <typename Range>
+        concept xorstr_range = std::ranges::forward_range<Range> && is_xorstr<std::ranges::range_value_t<Range>> &&
+                               std::is_lvalue_reference_v<std::ranges::range_reference_t<Range>> &&
+                               !std::is_const_v<std::remove_reference_t<std::ranges::range_reference_t<Range>>>;
+    } // namespace detail
+
+    /**
+     * @brief 一次解密多个 xorstr（类型可以各不相同）。每个对象的块数与密钥都是编译期常量，
+     * 折叠展开后是一段不含循环的直线代码，乱序执行可以把各对象的异或交错起来；已是明文的对象被跳过。
+     */
+    template <typename... Xors>
+        requires(sizeof...(Xors) > 0 && (detail::is_xorstr<Xors> && ...))
+    inline void reveal_all(Xors &...objs) noexcept {
+        (detail::batch::toggle<true>(objs), ...);
+    }
+
+    /**
+     * @brief 与 reveal_all(objs...) 对应的批量加密
+     */
+    template <typename... Xors>
+        requires(sizeof...(Xors) > 0 && (detail::is_xorstr<Xors> && ...))
+    inline void encrypt_all(Xors &...objs) noexcept {
+        (detail::batch::toggle<false>(objs), ...);
+    }
+
+    /**
+     * @brief 批量解密同一类型 xorstr 组成的范围（数组、std::vector、std::span 等），
+     * 整批只准备一次密钥与内核，适合启动时集中展开大量配置项
+     */
+    template <detail::xorstr_range Range> inline void reveal_all(Range &&objs) noexcept {
+        detail::batch::toggle_range<true>(objs);
+    }
+
+    template <detail::xorstr_range Range> inline void encrypt_all(Range &&objs) noexcept {
+        detail::batch::toggle_range<false>(objs);
+    }
+
+    namespace detail {
+        /**
+         * @brief 每个调用点独享的静态明文缓存，常量初始化为零，不经过 __cxa_guard
+         */
+        template <typename Site, typename Xor> struct cached_site {
+            enum : uint8_t { empty, busy, ready };
+
+            alignas(Xor::storage_alignment) static inline decltype(Xor::encrypted_blocks) plain_blocks{};
+            static inline std::atomic<uint8_t> state{empty};
+        };
+    } // namespace detail
+
+    /**
+     * @brief 首次调用时解密到调用点的静态存储，之后只做一次 acquire 读取。
+     * 首次初始化由 CAS 抢占，竞争失败的线程在 atomic::wait 上等待，不使用互斥锁。
+     * @param make 构造 xorstr 的无捕获 lambda，其类型唯一标识调用点
+     * @return 指向静态存储的视图，程序运行期间一直有效（明文也一直驻留内存）
+     */
+    template <typename Make> [[nodiscard]] inline auto reveal_cached(Make make) noexcept {
+        using xor_type = decltype(make());
+        using site = detail::cached_site<Make, xor_type>;
+        using view_type = std::basic_string_view<typename xor_type::value_type>;
+        const auto *plain = reinterpret_cast<const typename xor_type::value_type *>(site::plain_blocks.data());
+
+        uint8_t state = site::state.load(std::memory_order_acquire);
+        if (state != site::ready) [[unlikely]] {
+            if (state == site::empty &&
+                site::state.compare_exchange_strong(state, site::busy, std::memory_order_acquire)) {
+                const xor_type encrypted = make();
+                xor_type::apply_keystream(site::plain_blocks.data(), encrypted.encrypted_blocks.data());
+                site::state.store(site::ready, std::memory_order_release);
+                site::state.notify_all();
+            } else {
+                while ((state = site::state.load(std::memory_order_acquire)) != site::ready) {
+                    site::state.wait(state, std::memory_order_acquire);
+                }
+            }
+        }
+        return view_type{plain, xor_type::size()};
     }
 } // namespace fantasy
+// 宏使用的密钥流策略。改用其他策略时须在包含第一个 xorstr 头文件之前定义，例如 fantasy::aes_ctr_keys
+#ifndef XORSTR_KEYSTREAM
+#define XORSTR_KEYSTREAM fantasy::splitmix_keys
+#endif
+
 // 高熵编译期种子，确保每个调用点不同
-#define COMPILETIME_SEED (__COUNTER__ * __LINE__ * 0xCBF29CE484222325ULL + __TIME__[0] + __TIME__[4])
+// 与调用点无关的种子成分。定义 XORSTR_BUILD_SEED（CMake 缓存变量同名）后改用固定的构建种子，
+// 并按翻译单元混入 __FILE__ 的哈希，重复构建得到相同的目标文件，便于 ccache / 分布式构建缓存命中
+#ifdef XORSTR_BUILD_SEED
+#define XORSTR_SEED_ENTROPY                                                                                            \
+    (static_cast<uint64_t>(XORSTR_BUILD_SEED) ^ fantasy::xorstr_hash(std::string_view{__FILE__}))
+#else
+#define XORSTR_SEED_ENTROPY (__TIME__[0] + __TIME__[4])
+#endif
+
+#define COMPILETIME_SEED (__COUNTER__ * __LINE__ * 0xCBF29CE484222325ULL + XORSTR_SEED_ENTROPY)
+
+// 去重模式的种子：只由内容与构建种子决定，所有翻译单元一致。未定义 XORSTR_BUILD_SEED 时使用固定常量；
+// 经 indexed_key_gen 混合，种子与 XORSTR_HASH 的值之间没有直接关系
+#ifdef XORSTR_BUILD_SEED
+#define XORSTR_DEDUP_ENTROPY static_cast<uint64_t>(XORSTR_BUILD_SEED)
+#else
+#define XORSTR_DEDUP_ENTROPY 0x9E3779B97F4A7C15ULL
+#endif
+#define XORSTR_CONTENT_SEED(s)                                                                                         \
+    fantasy::indexed_key_gen(XORSTR_DEDUP_ENTROPY, fantasy::xorstr_hash(std::basic_string_view{s, std::size(s) - 1}))
+
+// 在常量表达式中完成加密并返回副本，明文不会进入二进制文件
+#if XORSTR_DEDUP
+#define XORSTR_ENCRYPT(s)                                                                                              \
+    [] {                                                                                                               \
+        constexpr auto encrypted = fantasy::make_xorstr<XORSTR_CONTENT_SEED(s), XORSTR_KEYSTREAM>(s);                  \
+        return encrypted.template shared<encrypted.encrypted_blocks>();                                                \
+    }
+#else
+#define XORSTR_ENCRYPT(s)                                                                                              \
+    [] {                                                                                                               \
+        constexpr auto encrypted = fantasy::make_xorstr<COMPILETIME_SEED, XORSTR_KEYSTREAM>(s);                        \
+        return encrypted;                                                                                              \
+    }
+#endif
+
+// 字面量（不含末尾的 '\0'）的编译期哈希，可直接用作 case 标签，明文不会进入二进制文件
+#define XORSTR_HASH(s)                                                                                                 \
+    (std::integral_constant<uint64_t, fantasy::xorstr_hash(std::basic_string_view{s, std::size(s) - 1})>::value)
 
 // 确保每次调用的初始种子都不一样
-#define XOR_STR(s) fantasy::make_xorstr<COMPILETIME_SEED>(s).reveal()
+#define XOR_STR(s) XORSTR_ENCRYPT(s)().reveal()
+
+// 与 XOR_STR 相同，但返回带长度的 std::basic_string_view，同样只在当前完整表达式内有效
+#define XOR_STR_VIEW(s) XORSTR_ENCRYPT(s)().reveal_view()
+
+// 每个调用点只解密一次，返回指向静态存储的 std::basic_string_view，适合热循环（明文常驻内存）
+#define XOR_STR_CACHED(s) fantasy::reveal_cached(XORSTR_ENCRYPT(s))
+
+// 返回持有明文的 fantasy::revealed 句柄，可安全地跨语句使用，离开作用域时清零
+#define XOR_STR_SCOPED(s) XORSTR_ENCRYPT(s)().reveal_scoped()
@@ -0,0 +1,477 @@
+#pragma once
+#include <fantasy/xorstr.hpp>
+
+namespace fantasy {
+    namespace detail::aes {
+        using block = std::array<uint8_t, 16>;
+
+        // 11 个轮密钥（AES-128），按字节顺序排列
+        using schedule = std::array<block, 11>;
+
+        constexpr uint8_t xtime(uint8_t a) { return static_cast<uint8_t>((a << 1) ^ ((a & 0x80) ? 0x1B : 0)); }
+
+        constexpr uint8_t rotl8(uint8_t a, int n) { return static_cast<uint8_t>((a << n) | (a >> (8 - n))); }
+
+        /**
+         * @brief 在编译期生成 S 盒：3 是 GF(2^8) 的生成元，同时遍历 3^k 与 3^-k 得到乘法逆元，再做仿射变换
+         */
+        constexpr std::array<uint8_t, 256> make_sbox() {
+            std::array<uint8_t, 256> box{};
+            uint8_t p = 1;
+            uint8_t q = 1;
+            do {
+                p = static_cast<uint8_t>(p ^ xtime(p));
+                q = static_cast<uint8_t>(q ^ (q << 1));
+                q = static_cast<uint8_t>(q ^ (q << 2));
+                q = static_cast<uint8_t>(q ^ (q << 4));
+                if (q & 0x80) {
+                    q ^= 0x09;
+                }
+                box[p] = static_cast<uint8_t>(q ^ rotl8(q, 1) ^ rotl8(q, 2) ^ rotl8(q, 3) ^ rotl8(q, 4) ^ 0x63);
+            } while (p != 1);
+            box[0] = 0x63;
+            return box;
+        }
+
+        inline constexpr std::array<uint8_t, 256> sbox = make_sbox();
+
+        constexpr schedule expand_key(const block &key) {
+            schedule rk{};
+            rk[0] = key;
+            uint8_t rcon = 1;
+            for (size_t r = 1; r < rk.size(); ++r) {
+                const block &prev = rk[r - 1];
+                const uint8_t t[4] = {static_cast<uint8_t>(sbox[prev[13]] ^ rcon), sbox[prev[14]], sbox[prev[15]],
+                                      sbox[prev[12]]};
+                for (size_t i = 0; i < 4; ++i) {
+                    rk[r][i] = static_cast<uint8_t>(prev[i] ^ t[i]);
+                }
+                for (size_t i = 4; i < 16; ++i) {
+                    rk[r][i] = static_cast<uint8_t>(prev[i] ^ rk[r][i - 4]);
+                }
+                rcon = xtime(rcon);
+            }
+            return rk;
+        }
+
+        /**
+         * @brief 软件实现的 AES-128 单块加密（FIPS-197，状态按列主序存放），用于编译期加密与运行期兜底
+         */
+        constexpr block encrypt_block(const schedule &rk, block s) {
+            for (size_t i = 0; i < 16; ++i) {
+                s[i] ^= rk[0][i];
+            }
+            for (size_t r = 1; r < rk.size(); ++r) {
+                // SubBytes + ShiftRows
+                block t{};
+                for (size_t c = 0; c < 4; ++c) {
+                    for (size_t row = 0; row < 4; ++row) {
+                        t[row + 4 * c] = sbox[s[row + 4 * ((c + row) % 4)]];
+                    }
+                }
+                if (r != rk.size() - 1) {
+                    for (size_t c = 0; c < 4; ++c) {
+                        const uint8_t a0 = t[4 * c], a1 = t[4 * c + 1], a2 = t[4 * c + 2], a3 = t[4 * c + 3];
+                        t[4 * c] = static_cast<uint8_t>(xtime(a0) ^ xtime(a1) ^ a1 ^ a2 ^ a3);
+                        t[4 * c + 1] = static_cast<uint8_t>(a0 ^ xtime(a1) ^ xtime(a2) ^ a2 ^ a3);
+                        t[4 * c + 2] = static_cast<uint8_t>(a0 ^ a1 ^ xtime(a2) ^ xtime(a3) ^ a3);
+                        t[4 * c + 3] = static_cast<uint8_t>(xtime(a0) ^ a0 ^ a1 ^ a2 ^ xtime(a3));
+                    }
+                }
+                for (size_t i = 0; i < 16; ++i) {
+                    s[i] = static_cast<uint8_t>(t[i] ^ rk[r][i]);
+                }
+            }
+            return s;
+        }
+
+        /**
+         * @brief 每个调用点的 AES 密钥与 nonce，由种子经 indexed_key_gen 派生（与 splitmix 密钥流的下标不重叠）
+         */
+        struct key_material {
+            block key;
+            uint64_t nonce;
+        };
+
+        constexpr key_material derive(uint64_t seed) {
+            constexpr size_t base = ~size_t{0};
+            const std::array<uint64_t, 2> key{indexed_key_gen(seed, base), indexed_key_gen(seed, base - 1)};
+            return {std::bit_cast<block>(key), indexed_key_gen(seed, base - 2)};
+        }
+
+        /**
+         * @brief 第 index 个计数器块：[nonce | index]，两个 64 位字按本机字节序存放
+         */
+        constexpr block counter_block(uint64_t nonce, uint64_t index) {
+            return std::bit_cast<block>(std::array<uint64_t, 2>{nonce, index});
+        }
+
+        inline constexpr size_t block_bytes = 16;
+
+        /**
+         * @brief 运行期 CTR 内核：dst[j] = src[j] ^ 密钥流第 offset + j 个字节（j < bytes）
+         */
+        using ctr_kernel = void (*)(void *dst, const void *src, const key_material &km, size_t offset,
+                                    size_t bytes) noexcept;
+
+        /**
+         * @brief 不完整的块：用一块密钥流处理从块内第 skip 个字节开始的 take 个字节
+         */
+        inline void xor_partial(unsigned char *out, const unsigned char *in, const uint8_t *ks, size_t skip,
+                                size_t take) noexcept {
+            for (size_t j = 0; j < take; ++j) {
+                out[j] = static_cast<unsigned char>(in[j] ^ ks[skip + j]);
+            }
+        }
+
+        inline void ctr_soft(void *dst, const void *src, const key_material &km, size_t offset,
+                             size_t bytes) noexcept {
+            const schedule rk = expand_key(km.key);
+            const auto *in = static_cast<const unsigned char *>(src);
+            auto *out = static_cast<unsigned char *>(dst);
+            uint64_t index = offset / block_bytes;
+            size_t skip = offset % block_bytes;
+            while (bytes > 0) {
+                const block ks = encrypt_block(rk, counter_block(km.nonce, index++));
+                const size_t take = std::min(block_bytes - skip, bytes);
+                xor_partial(out, in, ks.data(), skip, take);
+                in += take;
+                out += take;
+                bytes -= take;
+                skip = 0;
+            }
+        }
+
+#if defined(XORSTR_ARCH_X86)
+        template <int Rcon> XORSTR_TARGET("aes,sse2") inline __m128i aesni_next_key(__m128i key) noexcept {
+            __m128i assist = _mm_shuffle_epi32(_mm_aeskeygenassist_si128(key, Rcon), 0xFF);
+            key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+            key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+            key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+            return _mm_xor_si128(key, assist);
+        }
+
+        XORSTR_TARGET("aes,sse2") inline void aesni_expand(const block &key, __m128i (&rk)[11]) noexcept {
+            rk[0] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(key.data()));
+            rk[1] = aesni_next_key<0x01>(rk[0]);
+            rk[2] = aesni_next_key<0x02>(rk[1]);
+            rk[3] = aesni_next_key<0x04>(rk[2]);
+            rk[4] = aesni_next_key<0x08>(rk[3]);
+            rk[5] = aesni_next_key<0x10>(rk[4]);
+            rk[6] = aesni_next_key<0x20>(rk[5]);
+            rk[7] = aesni_next_key<0x40>(rk[6]);
+            rk[8] = aesni_next_key<0x80>(rk[7]);
+            rk[9] = aesni_next_key<0x1B>(rk[8]);
+            rk[10] = aesni_next_key<0x36>(rk[9]);
+        }
+
+        XORSTR_TARGET("aes,sse2") inline __m128i aesni_encrypt(const __m128i (&rk)[11], __m128i b) noexcept {
+            b = _mm_xor_si128(b, rk[0]);
+            for (int r = 1; r < 10; ++r) {
+                b = _mm_aesenc_si128(b, rk[r]);
+            }
+            return _mm_aesenclast_si128(b, rk[10]);
+        }
+
+        XORSTR_TARGET("aes,sse2") inline __m128i aesni_counter(uint64_t nonce, uint64_t index) noexcept {
+            return _mm_set_epi64x(static_cast<long long>(index), static_cast<long long>(nonce));
+        }
+
+        /**
+         * @brief 逐块处理从第 index 个计数器块的第 skip 个字节开始的 bytes 个字节，用于头尾与零散整块
+         */
+        XORSTR_TARGET("aes,sse2")
+        inline void aesni_serial(const __m128i (&rk)[11], uint64_t nonce, unsigned char *out, const unsigned char *in,
+                                 uint64_t index, size_t skip, size_t bytes) noexcept {
+            while (bytes > 0) {
+                const __m128i ks = aesni_encrypt(rk, aesni_counter(nonce, index++));
+                const size_t take = std::min(block_bytes - skip, bytes);
+                if (take == block_bytes) {
+                    const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_xor_si128(data, ks));
+                } else {
+                    alignas(16) uint8_t ks_bytes[block_bytes];
+                    _mm_store_si128(reinterpret_cast<__m128i *>(ks_bytes), ks);
+                    xor_partial(out, in, ks_bytes, skip, take);
+                }
+                in += take;
+                out += take;
+                bytes -= take;
+                skip = 0;
+            }
+        }
+
+        /**
+         * @brief AES-NI：每轮迭代 4 个计数器块交错执行，掩盖 aesenc 的延迟
+         */
+        XORSTR_TARGET("aes,sse2")
+        inline void ctr_aesni(void *dst, const void *src, const key_material &km, size_t offset,
+                              size_t bytes) noexcept {
+            __m128i rk[11];
+            aesni_expand(km.key, rk);
+            const auto *in = static_cast<const unsigned char *>(src);
+            auto *out = static_cast<unsigned char *>(dst);
+            uint64_t index = offset / block_bytes;
+            if (const size_t skip = offset % block_bytes; skip != 0) {
+                const size_t head = std::min(block_bytes - skip, bytes);
+                aesni_serial(rk, km.nonce, out, in, index++, skip, head);
+                in += head;
+                out += head;
+                bytes -= head;
+            }
+            // 四个独立的变量而不是数组，否则 GCC 不展开内层循环，状态经过栈往返，流水线被串行化
+            constexpr size_t lanes = 4;
+            for (; bytes >= lanes * block_bytes; bytes -= lanes * block_bytes) {
+                __m128i b0 = _mm_xor_si128(aesni_counter(km.nonce, index), rk[0]);
+                __m128i b1 = _mm_xor_si128(aesni_counter(km.nonce, index + 1), rk[0]);
+                __m128i b2 = _mm_xor_si128(aesni_counter(km.nonce, index + 2), rk[0]);
+                __m128i b3 = _mm_xor_si128(aesni_counter(km.nonce, index + 3), rk[0]);
+                for (int r = 1; r < 10; ++r) {
+                    b0 = _mm_aesenc_si128(b0, rk[r]);
+                    b1 = _mm_aesenc_si128(b1, rk[r]);
+                    b2 = _mm_aesenc_si128(b2, rk[r]);
+                    b3 = _mm_aesenc_si128(b3, rk[r]);
+                }
+                const auto *src_blocks = reinterpret_cast<const __m128i *>(in);
+                auto *dst_blocks = reinterpret_cast<__m128i *>(out);
+                const __m128i d0 = _mm_loadu_si128(src_blocks);
+                const __m128i d1 = _mm_loadu_si128(src_blocks + 1);
+                const __m128i d2 = _mm_loadu_si128(src_blocks + 2);
+                const __m128i d3 = _mm_loadu_si128(src_blocks + 3);
+                _mm_storeu_si128(dst_blocks, _mm_xor_si128(d0, _mm_aesenclast_si128(b0, rk[10])));
+                _mm_storeu_si128(dst_blocks + 1, _mm_xor_si128(d1, _mm_aesenclast_si128(b1, rk[10])));
+                _mm_storeu_si128(dst_blocks + 2, _mm_xor_si128(d2, _mm_aesenclast_si128(b2, rk[10])));
+                _mm_storeu_si128(dst_blocks + 3, _mm_xor_si128(d3, _mm_aesenclast_si128(b3, rk[10])));
+                index += lanes;
+                in += lanes * block_bytes;
+                out += lanes * block_bytes;
+            }
+            aesni_serial(rk, km.nonce, out, in, index, 0, bytes);
+        }
+
+        /**
+         * @brief VAES + AVX2：一条 YMM 指令处理两个计数器块，每轮迭代 4 个 YMM 共 8 块
+         */
+        XORSTR_TARGET("vaes,avx2,aes,sse2")
+        inline void ctr_vaes(void *dst, const void *src, const key_material &km, size_t offset,
+                             size_t bytes) noexcept {
+            __m128i rk[11];
+            aesni_expand(km.key, rk);
+            const auto *in = static_cast<const unsigned char *>(src);
+            auto *out = static_cast<unsigned char *>(dst);
+            uint64_t index = offset / block_bytes;
+            if (const size_t skip = offset % block_bytes; skip != 0) {
+                const size_t head = std::min(block_bytes - skip, bytes);
+                aesni_serial(rk, km.nonce, out, in, index++, skip, head);
+                in += head;
+                out += head;
+                bytes -= head;
+            }
+            constexpr size_t lanes = 4;
+            constexpr size_t step = lanes * 2 * block_bytes;
+            if (bytes >= step) {
+                __m256i wide[11];
+                for (size_t r = 0; r < 11; ++r) {
+                    wide[r] = _mm256_broadcastsi128_si256(rk[r]);
+                }
+                const auto nonce = static_cast<long long>(km.nonce);
+                for (; bytes >= step; bytes -= step) {
+                    const auto first = static_cast<long long>(index);
+                    __m256i b0 = _mm256_xor_si256(_mm256_set_epi64x(first + 1, nonce, first, nonce), wide[0]);
+                    __m256i b1 = _mm256_xor_si256(_mm256_set_epi64x(first + 3, nonce, first + 2, nonce), wide[0]);
+                    __m256i b2 = _mm256_xor_si256(_mm256_set_epi64x(first + 5, nonce, first + 4, nonce), wide[0]);
+                    __m256i b3 = _mm256_xor_si256(_mm256_set_epi64x(first + 7, nonce, first + 6, nonce), wide[0]);
+                    for (int r = 1; r < 10; ++r) {
+                        b0 = _mm256_aesenc_epi128(b0, wide[r]);
+                        b1 = _mm256_aesenc_epi128(b1, wide[r]);
+                        b2 = _mm256_aesenc_epi128(b2, wide[r]);
+                        b3 = _mm256_aesenc_epi128(b3, wide[r]);
+                    }
+                    const auto *src_blocks = reinterpret_cast<const __m256i *>(in);
+                    auto *dst_blocks = reinterpret_cast<__m256i *>(out);
+                    const __m256i d0 = _mm256_loadu_si256(src_blocks);
+                    const __m256i d1 = _mm256_loadu_si256(src_blocks + 1);
+                    const __m256i d2 = _mm256_loadu_si256(src_blocks + 2);
+                    const __m256i d3 = _mm256_loadu_si256(src_blocks + 3);
+                    _mm256_storeu_si256(dst_blocks, _mm256_xor_si256(d0, _mm256_aesenclast_epi128(b0, wide[10])));
+                    _mm256_storeu_si256(dst_blocks + 1, _mm256_xor_si256(d1, _mm256_aesenclast_epi128(b1, wide[10])));
+                    _mm256_storeu_si256(dst_blocks + 2, _mm256_xor_si256(d2, _mm256_aesenclast_epi128(b2, wide[10])));
+                    _mm256_storeu_si256(dst_blocks + 3, _mm256_xor_si256(d3, _mm256_aesenclast_epi128(b3, wide[10])));
+                    index += 2 * lanes;
+                    in += step;
+                    out += step;
+                }
+            }
+            aesni_serial(rk, km.nonce, out, in, index, 0, bytes);
+        }
+#endif
+
+#if defined(XORSTR_ARCH_NEON) && (defined(__ARM_FEATURE_AES) || defined(__ARM_FEATURE_CRYPTO))
+#define XORSTR_AES_ARMV8 1
+        /**
+         * @brief ARMv8 Crypto 扩展：AESE 先异或轮密钥再做 SubBytes/ShiftRows，因此最后一轮单独异或 rk[10]
+         */
+        inline void ctr_armv8(void *dst, const void *src, const key_material &km, size_t offset,
+                              size_t bytes) noexcept {
+            const schedule soft = expand_key(km.key);
+            uint8x16_t rk[11];
+            for (size_t r = 0; r < 11; ++r) {
+                rk[r] = vld1q_u8(soft[r].data());
+            }
+            const auto *in = static_cast<const unsigned char *>(src);
+            auto *out = static_cast<unsigned char *>(dst);
+            uint64_t index = offset / block_bytes;
+            size_t skip = offset % block_bytes;
+            while (bytes > 0) {
+                const uint64x2_t counter = vcombine_u64(vcreate_u64(km.nonce), vcreate_u64(index++));
+                uint8x16_t b = vreinterpretq_u8_u64(counter);
+                for (size_t r = 0; r < 9; ++r) {
+                    b = vaesmcq_u8(vaeseq_u8(b, rk[r]));
+                }
+                b = veorq_u8(vaeseq_u8(b, rk[9]), rk[10]);
+                const size_t take = std::min(block_bytes - skip, bytes);
+                if (take == block_bytes) {
+                    vst1q_u8(out, veorq_u8(vld1q_u8(in), b));
+                } else {
+                    uint8_t ks[block_bytes];
+                    vst1q_u8(ks, b);
+                    xor_partial(out, in, ks, skip, take);
+                }
+                in += take;
+                out += take;
+                bytes -= take;
+                skip = 0;
+            }
+        }
+#endif
+
+        enum class backend : uint8_t { soft, aesni, vaes, armv8 };
+
+        /**
+         * @brief 查询当前 CPU 是否支持指定的 AES 后端
+         */
+        [[nodiscard]] inline bool cpu_supports(backend level) noexcept {
+            switch (level) {
+            case backend::soft:
+                return true;
+#if defined(XORSTR_ARCH_X86)
+#if defined(_MSC_VER) && !defined(__clang__)
+            case backend::aesni:
+            case backend::vaes: {
+                int regs[4]{};
+                __cpuid(regs, 1);
+                if ((regs[2] & (1 << 25)) == 0) {
+                    return false;
+                }
+                if (level == backend::aesni) {
+                    return true;
+                }
+                __cpuidex(regs, 7, 0);
+                return (regs[2] & (1 << 9)) != 0 && detail::cpu_supports(isa::avx2);
+            }
+#else
+            case backend::aesni:
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("aes");
+            case backend::vaes:
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("aes") && __builtin_cpu_supports("vaes") &&
+                       __builtin_cpu_supports("avx2");
+#endif
+#endif
+#if defined(XORSTR_AES_ARMV8)
+            case backend::armv8:
+                return true;
+#endif
+            default:
+                return false;
+            }
+        }
+
+        [[nodiscard]] inline ctr_kernel kernel_for(backend level) noexcept {
+            switch (level) {
+#if defined(XORSTR_ARCH_X86)
+            case backend::aesni:
+                return &ctr_aesni;
+            case backend::vaes:
+                return &ctr_vaes;
+#endif
+#if defined(XORSTR_AES_ARMV8)
+            case backend::armv8:
+                return &ctr_armv8;
+#endif
+            default:
+                return &ctr_soft;
+            }
+        }
+
+        /**
+         * @brief 运行期可用的最快后端；VAES 使用 YMM，受 XORSTR_VECTOR_WIDTH 限制
+         */
+        [[nodiscard]] inline backend runtime_backend() noexcept {
+            if (XORSTR_VECTOR_WIDTH >= 256 && cpu_supports(backend::vaes)) {
+                return backend::vaes;
+            }
+            for (const backend level : {backend::aesni, backend::armv8}) {
+                if (cpu_supports(level)) {
+                    return level;
+                }
+            }
+            return backend::soft;
+        }
+
+        inline void resolve_ctr(void *dst, const void *src, const key_material &km, size_t offset,
+                                size_t bytes) noexcept;
+
+        /**
+         * @brief 当前生效的 CTR 内核，与 active_kernel 相同：常量初始化，首次调用时检测一次 CPU 并替换自身
+         */
+        inline std::atomic<ctr_kernel> active_ctr{&resolve_ctr};
+
+        inline void resolve_ctr(void *dst, const void *src, const key_material &km, size_t offset,
+                                size_t bytes) noexcept {
+            const ctr_kernel kernel = kernel_for(runtime_backend());
+            active_ctr.store(kernel, std::memory_order_relaxed);
+            kernel(dst, src, km, offset, bytes);
+        }
+    } // namespace detail::aes
+
+    /**
+     * @brief AES-128-CTR 密钥流策略。每个调用点的 AES 密钥与 nonce 由种子派生，
+     * 第 b 个计数器块加密后的 16 字节依次作为第 2b、2b + 1 个字的密钥。
+     * 编译期用软件 AES 加密，运行期按 CPU 选择 VAES、AES-NI、ARMv8 Crypto 或软件实现。
+     * 不存储密钥表，密钥流也无法由种子的简单运算得到，代价是解密比默认的异或慢。
+     */
+    struct aes_ctr_keys {
+        template <size_t Words> static constexpr std::array<uint64_t, Words> keys(uint64_t seed) {
+            const detail::aes::key_material km = detail::aes::derive(seed);
+            const detail::aes::schedule rk = detail::aes::expand_key(km.key);
+            std::array<uint64_t, Words> keys{};
+            for (size_t b = 0; 2 * b < Words; ++b) {
+                const auto ks = std::bit_cast<std::array<uint64_t, 2>>(
+                    detail::aes::encrypt_block(rk, detail::aes::counter_block(km.nonce, b)));
+                keys[2 * b] = ks[0];
+                if (2 * b + 1 < Words) {
+                    keys[2 * b + 1] = ks[1];
+                }
+            }
+            return keys;
+        }
+
+        [[nodiscard]] static uint64_t word(uint64_t seed, size_t index) noexcept {
+            constexpr uint64_t zero = 0;
+            uint64_t key;
+            apply(&key, &zero, seed, index * sizeof(uint64_t), sizeof(uint64_t));
+            return key;
+        }
+
+        static void apply(void *dst, const void *src, uint64_t seed, size_t offset, size_t bytes) noexcept {
+            const detail::aes::key_material km = detail::aes::derive(seed);
+            detail::aes::active_ctr.load(std::memory_order_relaxed)(dst, src, km, offset, bytes);
+        }
+    };
+} // namespace fantasy
+
+// 让 XOR_STR 系列宏改用 AES-CTR 密钥流：在包含第一个 xorstr 头文件之前定义（或用 -D 传入）
+// XORSTR_KEYSTREAM=fantasy::aes_ctr_keys，并在使用宏之前包含本头文件。
+// xorstr.hpp 在未定义时会给出默认值，包含之后再定义属于重定义
@@ -0,0 +1,138 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <fantasy/xorstr.hpp>
+
+namespace fantasy {
+    /**
+     * @brief 解密用的线性（bump）分配区：按块向系统申请内存，分配只移动游标，
+     * 由 scope 在离开作用域时整体回退并清零回退部分。块在回退后保留，之后的请求不再访问堆。
+     * 每个线程通过 local() 使用自己的实例，多线程请求处理之间没有分配器争用。
+     */
+    class xorstr_arena {
+    public:
+        static constexpr size_t default_block_bytes = size_t{64} << 10;
+
+        /**
+         * @brief 作用域标记：构造时记录当前游标，析构时清零并释放此后的全部分配，可以嵌套
+         */
+        class scope {
+        public:
+            explicit scope(xorstr_arena &arena = xorstr_arena::local()) noexcept
+                : arena(arena), block(arena.current), offset(arena.offset) {}
+
+            scope(const scope &) = delete;
+            scope &operator=(const scope &) = delete;
+
+            ~scope() { arena.rewind(block, offset); }
+
+        private:
+            xorstr_arena &arena;
+            size_t block;
+            size_t offset;
+        };
+
+        explicit xorstr_arena(size_t block_bytes = default_block_bytes) noexcept : block_bytes(block_bytes) {}
+
+        xorstr_arena(const xorstr_arena &) = delete;
+        xorstr_arena &operator=(const xorstr_arena &) = delete;
+
+        ~xorstr_arena() { rewind(0, 0); }
+
+        /**
+         * @brief 当前线程的分配区
+         */
+        [[nodiscard]] static xorstr_arena &local() noexcept {
+            thread_local xorstr_arena arena;
+            return arena;
+        }
+
+        /**
+         * @brief 分配 bytes 个字节，按 alignment（2 的幂）对齐。当前块放不下时切换到下一块，
+         * 没有下一块或下一块太小时才向堆申请
+         */
+        [[nodiscard]] void *allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+            while (current < blocks.size()) {
+                block &slot = blocks[current];
+                const auto base = static_cast<size_t>(reinterpret_cast<std::uintptr_t>(slot.data.get()));
+                const size_t start = align_up(base + offset, alignment) - base;
+                if (start + bytes <= slot.size) {
+                    offset = start + bytes;
+                    return slot.data.get() + start;
+                }
+                ++current;
+                offset = 0;
+            }
+            const size_t size = std::max(block_bytes, bytes + alignment);
+            blocks.push_back(block{std::make_unique_for_overwrite<unsigned char[]>(size), size});
+            current = blocks.size() - 1;
+            offset = 0;
+            return allocate(bytes, alignment);
+        }
+
+        /**
+         * @brief 当前已分配的字节数（含对齐填充与块尾未用的部分）
+         */
+        [[nodiscard]] size_t used() const noexcept {
+            size_t total = offset;
+            for (size_t i = 0; i < current && i < blocks.size(); ++i) {
+                total += blocks[i].size;
+            }
+            return total;
+        }
+
+        /**
+         * @brief 已向堆申请的总字节数
+         */
+        [[nodiscard]] size_t capacity() const noexcept {
+            size_t total = 0;
+            for (const block &slot : blocks) {
+                total += slot.size;
+            }
+            return total;
+        }
+
+    private:
+        struct block {
+            std::unique_ptr<unsigned char[]> data;
+            size_t size;
+        };
+
+        /**
+         * @brief 清零 (block, offset) 之后的全部已用空间并把游标移回去
+         */
+        void rewind(size_t block_index, size_t block_offset) noexcept {
+            for (size_t i = block_index; i <= current && i < blocks.size(); ++i) {
+                const size_t begin = i == block_index ? block_offset : 0;
+                const size_t end = i == current ? offset : blocks[i].size;
+                if (end > begin) {
+                    detail::secure_wipe(blocks[i].data.get() + begin, end - begin);
+                }
+            }
+            current = block_index;
+            offset = block_offset;
+        }
+
+        std::vector<block> blocks;
+        size_t block_bytes;
+        size_t current = 0;
+        size_t offset = 0;
+    };
+
+    /**
+     * @brief 把 obj 的明文（含 '\0'）解密到分配区中，对象自身保持不变。
+     * 返回的视图在包住这次调用的 xorstr_arena::scope 结束前有效，不经过 malloc。
+     */
+    template <typename Xor>
+        requires detail::is_xorstr<Xor>
+    [[nodiscard]] inline std::basic_string_view<typename Xor::value_type>
+    reveal_into_arena(const Xor &obj, xorstr_arena &arena = xorstr_arena::local()) {
+        using char_type = typename Xor::value_type;
+        auto *dst = static_cast<char_type *>(arena.allocate(sizeof(char_type) * (obj.size() + 1), alignof(char_type)));
+        obj.decrypt_into(dst);
+        return {dst, obj.size()};
+    }
+} // namespace fantasy
+
+// 解密到当前线程的分配区，返回的 std::basic_string_view 在外层 xorstr_arena::scope 结束前有效
+#define XOR_STR_ARENA(s) fantasy::reveal_into_arena(XORSTR_ENCRYPT(s)())
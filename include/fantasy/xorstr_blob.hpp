@@ -0,0 +1,116 @@
+#pragma once
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <fantasy/xorstr.hpp>
+
+namespace fantasy {
+    namespace detail {
+        template <typename T>
+        concept byte_like = std::same_as<T, std::byte> || std::same_as<T, unsigned char> || std::same_as<T, char> ||
+                            std::same_as<T, signed char> || std::same_as<T, char8_t>;
+
+        // GCC 的 -fconstexpr-loop-limit 按单个循环计数（默认 262144），大块数据分段拷贝以免超限
+        inline constexpr std::size_t constexpr_loop_chunk = std::size_t{1} << 16;
+    } // namespace detail
+
+    /**
+     * @brief 大块二进制数据（着色器源码、许可证包、脚本等）的加密容器。
+     * 密钥流与 xorstr 相同，由 indexed_key_gen(Seed, i) 按字下标派生，不存储密钥表，
+     * 因此可以随机访问任意字节区间，也可以把不同区间交给不同线程并行解密。
+     * 对象本身从不原地解密，可以是 constexpr 对象，直接放在只读段中。
+     */
+    template <size_t Bytes, uint64_t Seed> class xorblob {
+    public:
+        static constexpr size_t block_words = align_up(Bytes, sizeof(uint64_t)) / sizeof(uint64_t);
+
+        /**
+         * @brief read_parallel() 分给每个任务的字节数，足够大以摊薄线程调度开销
+         */
+        static constexpr size_t parallel_chunk_bytes = size_t{1} << 16;
+
+        /**
+         * @brief 只能在编译期构造：明文只在常量求值中出现，也避免运行期在栈上生成数 MB 的临时数组
+         */
+        template <detail::byte_like T> consteval explicit xorblob(const T (&data)[Bytes]) {
+            std::array<unsigned char, block_words * sizeof(uint64_t)> bytes{};
+            for (size_t chunk = 0; chunk < Bytes; chunk += detail::constexpr_loop_chunk) {
+                const size_t end = std::min(Bytes, chunk + detail::constexpr_loop_chunk);
+                for (size_t i = chunk; i < end; ++i) {
+                    bytes[i] = static_cast<unsigned char>(data[i]);
+                }
+            }
+            encrypted_blocks = std::bit_cast<std::array<uint64_t, block_words>>(bytes);
+            for (size_t chunk = 0; chunk < block_words; chunk += detail::constexpr_loop_chunk) {
+                const size_t end = std::min(block_words, chunk + detail::constexpr_loop_chunk);
+                for (size_t i = chunk; i < end; ++i) {
+                    encrypted_blocks[i] ^= indexed_key_gen(Seed, i);
+                }
+            }
+        }
+
+        /**
+         * @brief 明文字节数
+         */
+        [[nodiscard]] static constexpr size_t size() noexcept { return Bytes; }
+
+        /**
+         * @brief 解密 [offset, offset + dst.size()) 到 dst，超出末尾的部分被截断。
+         * 只读访问密文，可以在多个线程中对不同区间同时调用，例如交给自己的线程池或
+         * std::for_each(std::execution::par_unseq, ...)。
+         * @return 写入的字节数，offset 越界时为 0
+         */
+        template <detail::byte_like T, size_t Extent>
+        size_t read(size_t offset, std::span<T, Extent> dst) const noexcept {
+            if (offset >= Bytes) {
+                return 0;
+            }
+            const size_t count = std::min(dst.size(), Bytes - offset);
+            detail::xor_byte_range(dst.data(), encrypted_blocks.data(), offset, count,
+                                   detail::seed_keystream{detail::opaque(Seed)});
+            return count;
+        }
+
+        /**
+         * @brief 与 read() 相同，但按 parallel_chunk_bytes 切分后由 threads 个线程并行解密。
+         * @param threads 线程数（含调用线程），0 表示 std::thread::hardware_concurrency()
+         * @return 写入的字节数，offset 越界时为 0
+         */
+        template <detail::byte_like T, size_t Extent>
+        size_t read_parallel(size_t offset, std::span<T, Extent> dst, unsigned threads = 0) const {
+            if (offset >= Bytes) {
+                return 0;
+            }
+            const size_t count = std::min(dst.size(), Bytes - offset);
+            const size_t chunks = (count + parallel_chunk_bytes - 1) / parallel_chunk_bytes;
+            if (threads == 0) {
+                threads = std::max(1u, std::thread::hardware_concurrency());
+            }
+            const size_t workers = std::min<size_t>(threads, chunks);
+            if (workers <= 1) {
+                return read(offset, dst.first(count));
+            }
+
+            std::atomic<size_t> next{0};
+            const auto work = [&] {
+                for (size_t chunk; (chunk = next.fetch_add(1, std::memory_order_relaxed)) < chunks;) {
+                    const size_t begin = chunk * parallel_chunk_bytes;
+                    read(offset + begin, dst.subspan(begin, std::min(parallel_chunk_bytes, count - begin)));
+                }
+            };
+            std::vector<std::jthread> pool;
+            pool.reserve(workers - 1);
+            for (size_t i = 1; i < workers; ++i) {
+                pool.emplace_back(work);
+            }
+            work();
+            return count;
+        }
+
+        alignas(detail::storage_alignment<Bytes>) std::array<uint64_t, block_words> encrypted_blocks{};
+    };
+
+    template <uint64_t Seed, detail::byte_like T, size_t N> consteval auto make_xorblob(const T (&data)[N]) {
+        return xorblob<N, Seed>(data);
+    }
+} // namespace fantasy
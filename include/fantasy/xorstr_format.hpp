@@ -0,0 +1,367 @@
+#pragma once
+#include <charconv>
+#include <fantasy/xorstr.hpp>
+
+#if __has_include(<format>)
+#include <format>
+#endif
+#if defined(__cpp_lib_format) && __cpp_lib_format >= 202106L
+#define XORSTR_HAS_STD_FORMAT 1
+#else
+#define XORSTR_HAS_STD_FORMAT 0
+#endif
+
+namespace fantasy {
+    namespace detail::format {
+        // 以下函数故意不是 constexpr：格式串有误时在常量求值中调用它们，编译错误会指出具体的函数名
+        inline void unmatched_brace_in_format_string() {}
+        inline void mixed_automatic_and_manual_argument_indexing() {}
+        inline void nested_replacement_fields_are_not_supported() {}
+        inline void format_spec_needs_std_format() {}
+        inline void format_spec_too_long() {}
+
+        // 运行期解密用的栈上缓冲区（字符数），同时也是单个格式说明的长度上限
+        inline constexpr size_t chunk_chars = 64;
+
+        inline constexpr uint32_t no_field = ~uint32_t{0};
+
+        /**
+         * @brief 一段字面文本（已去掉 {{ / }} 转义）以及紧随其后的替换字段
+         */
+        struct piece {
+            uint32_t text_offset = 0;
+            uint32_t text_length = 0;
+            uint32_t arg = no_field;  // 字段引用的参数下标；最后一段没有字段
+            uint32_t spec_offset = 0; // 格式说明在文本中的位置，保存为 "{:spec}"，可直接交给 std::vformat_to
+            uint32_t spec_length = 0; // 0 表示没有格式说明
+        };
+
+        /**
+         * @brief 解析结果的规模，用来确定 xorformat 的模板参数
+         */
+        struct layout {
+            size_t text_chars = 0;
+            size_t fields = 0;
+            size_t args = 0;
+        };
+
+        /**
+         * @brief 解析格式串，对每段文本 / 每个字段调用 on_text(c) / on_field(arg, spec_begin, spec_end)。
+         * 语法与 std::format 相同，但不支持嵌套的动态宽度 / 精度字段
+         */
+        template <typename CharT, size_t N, typename OnText, typename OnField>
+        constexpr void parse(const CharT (&str)[N], OnText on_text, OnField on_field) {
+            bool automatic = false;
+            bool manual = false;
+            size_t next_arg = 0;
+            for (size_t i = 0; i + 1 < N;) {
+                const CharT c = str[i];
+                if (c == '}') {
+                    if (i + 2 >= N || str[i + 1] != '}') {
+                        unmatched_brace_in_format_string();
+                    }
+                    on_text(c);
+                    i += 2;
+                    continue;
+                }
+                if (c != '{') {
+                    on_text(c);
+                    ++i;
+                    continue;
+                }
+                if (i + 2 < N && str[i + 1] == '{') {
+                    on_text(c);
+                    i += 2;
+                    continue;
+                }
+                ++i;
+                size_t arg = 0;
+                if (i + 1 < N && str[i] >= '0' && str[i] <= '9') {
+                    manual = true;
+                    while (i + 1 < N && str[i] >= '0' && str[i] <= '9') {
+                        arg = arg * 10 + static_cast<size_t>(str[i] - '0');
+                        ++i;
+                    }
+                } else {
+                    automatic = true;
+                    arg = next_arg++;
+                }
+                if (automatic && manual) {
+                    mixed_automatic_and_manual_argument_indexing();
+                }
+                size_t spec_begin = i;
+                if (i + 1 < N && str[i] == ':') {
+                    spec_begin = ++i;
+                    while (i + 1 < N && str[i] != '}') {
+                        if (str[i] == '{') {
+                            nested_replacement_fields_are_not_supported();
+                        }
+                        ++i;
+                    }
+                }
+                if (i + 1 >= N || str[i] != '}') {
+                    unmatched_brace_in_format_string();
+                }
+                on_field(arg, spec_begin, i);
+                ++i;
+            }
+        }
+
+        template <typename CharT, size_t N> consteval layout measure(const CharT (&str)[N]) {
+            layout result;
+            parse(
+                str, [&](CharT) { ++result.text_chars; },
+                [&](size_t arg, size_t spec_begin, size_t spec_end) {
+                    if (spec_end > spec_begin) {
+                        if (!XORSTR_HAS_STD_FORMAT) {
+                            format_spec_needs_std_format();
+                        }
+                        if (spec_end - spec_begin + 3 > chunk_chars) {
+                            format_spec_too_long();
+                        }
+                        result.text_chars += spec_end - spec_begin + 3;
+                    }
+                    ++result.fields;
+                    result.args = std::max(result.args, arg + 1);
+                });
+            return result;
+        }
+
+        /**
+         * @brief 在不支持 <format> 的标准库上格式化一个参数：整数、浮点（最短往返表示）、bool、字符、
+         * 字符串与指针，输出与 std::format 的 "{}" 一致
+         */
+        template <typename CharT, typename Out, typename T> Out write_arg(Out out, const T &value) {
+            const auto put = [&out](const char *first, const char *last) {
+                for (; first != last; ++first) {
+                    *out = static_cast<CharT>(*first);
+                    ++out;
+                }
+            };
+            if constexpr (std::is_same_v<T, bool>) {
+                value ? put("true", "true" + 4) : put("false", "false" + 5);
+            } else if constexpr (std::is_same_v<T, CharT> || std::is_same_v<T, char>) {
+                *out = static_cast<CharT>(value);
+                ++out;
+            } else if constexpr (std::is_integral_v<T> || std::is_floating_point_v<T>) {
+                char buffer[64];
+                const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+                put(buffer, result.ptr);
+            } else if constexpr (std::is_convertible_v<const T &, std::basic_string_view<CharT>>) {
+                const std::basic_string_view<CharT> str = value;
+                out = std::ranges::copy(str, out).out;
+            } else if constexpr (std::is_pointer_v<T> || std::is_null_pointer_v<T>) {
+                char buffer[2 + 2 * sizeof(void *)] = {'0', 'x'};
+                const auto address = reinterpret_cast<std::uintptr_t>(static_cast<const void *>(value));
+                const auto result = std::to_chars(buffer + 2, buffer + sizeof(buffer), address, 16);
+                put(buffer, result.ptr);
+            } else {
+                static_assert(sizeof(T) == 0, "this argument type needs std::format, which the standard library lacks");
+            }
+            return out;
+        }
+
+        /**
+         * @brief 以运行期下标选出第 index 个参数并调用 f
+         */
+        template <typename F, typename... Args> void visit_arg(size_t index, F &&f, const Args &...args) {
+            size_t i = 0;
+            ((i++ == index ? f(args) : void()), ...);
+        }
+    } // namespace detail::format
+
+    /**
+     * @brief 加密的格式串：编译期解析并校验，字面文本首尾相接地加密在一个 xorstr 中，字段表只保存偏移与参数下标。
+     * 运行期不再解析格式串，也不生成明文格式串的临时副本：文本段解密后直接写入输出迭代器，
+     * 字段交给 std::format（不可用时使用内置的 "{}" 格式化）。对象从不原地解密，可以放在只读段中。
+     * @tparam TextChars 文本段（含各字段的格式说明）的总字符数
+     * @tparam Fields 替换字段个数
+     * @tparam Args 至少需要的参数个数
+     */
+    template <typename CharT, size_t TextChars, size_t Fields, size_t Args, uint64_t Seed> class xorformat {
+        static_assert(std::is_same_v<CharT, char> || std::is_same_v<CharT, wchar_t>,
+                      "xorformat supports char and wchar_t, like std::format");
+
+    public:
+        using value_type = CharT;
+
+        /**
+         * @brief 只能在编译期构造，text_chars / fields / args 必须与 detail::format::measure(str) 一致
+         */
+        template <size_t N> consteval explicit xorformat(const CharT (&str)[N]) : text(pack(str, pieces)) {}
+
+        /**
+         * @brief 按格式串格式化 args，写入 out 并返回写完后的迭代器
+         */
+        template <std::output_iterator<const CharT &> Out, typename... Ts>
+        Out format_to(Out out, const Ts &...args) const {
+            static_assert(sizeof...(Ts) >= Args, "too few arguments for the format string");
+            std::array<CharT, detail::format::chunk_chars> buffer;
+            for (const detail::format::piece &part : pieces) {
+                out = copy_text(out, part.text_offset, part.text_length, buffer);
+                if (part.arg == detail::format::no_field) {
+                    break;
+                }
+                detail::format::visit_arg(
+                    part.arg, [&](const auto &value) { out = format_field(out, part, value, buffer); }, args...);
+            }
+            detail::secure_wipe(buffer.data(), sizeof(buffer));
+            return out;
+        }
+
+        /**
+         * @brief 格式化为新的 std::basic_string
+         */
+        template <typename... Ts> [[nodiscard]] std::basic_string<CharT> format(const Ts &...args) const {
+            static_assert(sizeof...(Ts) >= Args, "too few arguments for the format string");
+            std::basic_string<CharT> result;
+            result.reserve(TextChars + 8 * Fields);
+            std::array<CharT, detail::format::chunk_chars> buffer;
+            for (const detail::format::piece &part : pieces) {
+                // 文本段直接解密进字符串自己的缓冲区，不逐字符 push_back
+                const size_t offset = result.size();
+                result.resize(offset + part.text_length);
+                text.read(part.text_offset, std::span<CharT>(result.data() + offset, part.text_length));
+                if (part.arg == detail::format::no_field) {
+                    break;
+                }
+                detail::format::visit_arg(
+                    part.arg, [&](const auto &value) { format_field(std::back_inserter(result), part, value, buffer); },
+                    args...);
+            }
+            detail::secure_wipe(buffer.data(), sizeof(buffer));
+            return result;
+        }
+
+        /**
+         * @brief 替换字段个数
+         */
+        [[nodiscard]] static constexpr size_t fields() noexcept { return Fields; }
+
+    private:
+        using text_type = xorstr<CharT, TextChars + 1, Seed>;
+
+        // pieces 必须先于 text 初始化：pack() 在填写文本的同时填写字段表
+        std::array<detail::format::piece, Fields + 1> pieces{};
+
+        text_type text;
+
+        template <size_t N>
+        static consteval text_type pack(const CharT (&str)[N], std::array<detail::format::piece, Fields + 1> &table) {
+            CharT chars[TextChars + 1]{};
+            size_t cursor = 0;
+            size_t field = 0;
+            // 先放所有字面文本，格式说明（若有）统一放在其后
+            detail::format::parse(
+                str, [&](CharT c) { chars[cursor++] = c; },
+                [&](size_t arg, size_t, size_t) {
+                    table[field].text_length = static_cast<uint32_t>(cursor - table[field].text_offset);
+                    table[field].arg = static_cast<uint32_t>(arg);
+                    table[++field].text_offset = static_cast<uint32_t>(cursor);
+                });
+            table[field].text_length = static_cast<uint32_t>(cursor - table[field].text_offset);
+            field = 0;
+            detail::format::parse(
+                str, [](CharT) {},
+                [&](size_t, size_t spec_begin, size_t spec_end) {
+                    if (spec_end > spec_begin) {
+                        table[field].spec_offset = static_cast<uint32_t>(cursor);
+                        chars[cursor++] = '{';
+                        chars[cursor++] = ':';
+                        for (size_t i = spec_begin; i < spec_end; ++i) {
+                            chars[cursor++] = str[i];
+                        }
+                        chars[cursor++] = '}';
+                        table[field].spec_length = static_cast<uint32_t>(spec_end - spec_begin + 3);
+                    }
+                    ++field;
+                });
+            return text_type(chars);
+        }
+
+        /**
+         * @brief 解密 [offset, offset + length) 的文本写入 out。连续迭代器直接解密到目标内存，
+         * 其余迭代器经栈上缓冲区分块拷贝
+         */
+        template <typename Out>
+        Out copy_text(Out out, size_t offset, size_t length,
+                      std::array<CharT, detail::format::chunk_chars> &buffer) const {
+            if constexpr (std::contiguous_iterator<Out>) {
+                text.read(offset, std::span<CharT>(std::to_address(out), length));
+                return out + static_cast<std::iter_difference_t<Out>>(length);
+            } else {
+                for (size_t done = 0; done < length;) {
+                    const size_t count =
+                        text.read(offset + done, std::span(buffer.data(), std::min(buffer.size(), length - done)));
+                    out = std::ranges::copy_n(buffer.data(), static_cast<std::ptrdiff_t>(count), out).out;
+                    done += count;
+                }
+                return out;
+            }
+        }
+
+        template <typename Out, typename T>
+        Out format_field(Out out, const detail::format::piece &part, const T &value,
+                         std::array<CharT, detail::format::chunk_chars> &buffer) const {
+#if XORSTR_HAS_STD_FORMAT
+            if (part.spec_length == 0) {
+                if constexpr (std::is_same_v<CharT, char>) {
+                    return std::format_to(std::move(out), "{}", value);
+                } else {
+                    return std::format_to(std::move(out), L"{}", value);
+                }
+            }
+            // 只解密这一个字段的 "{:spec}"，参数只有一个，因此自动编号即可
+            const size_t length = text.read(part.spec_offset, std::span(buffer.data(), part.spec_length));
+            const std::basic_string_view<CharT> spec(buffer.data(), length);
+            if constexpr (std::is_same_v<CharT, char>) {
+                return std::vformat_to(std::move(out), spec, std::make_format_args(value));
+            } else {
+                return std::vformat_to(std::move(out), spec, std::make_wformat_args(value));
+            }
+#else
+            (void)part;
+            (void)buffer;
+            return detail::format::write_arg<CharT>(std::move(out), value);
+#endif
+        }
+    };
+
+    template <uint64_t Seed, size_t TextChars, size_t Fields, size_t Args, typename CharT, size_t N>
+    consteval auto make_xorformat(const CharT (&str)[N]) {
+        return xorformat<CharT, TextChars, Fields, Args, Seed>(str);
+    }
+} // namespace fantasy
+
+// 在常量表达式中解析、校验并加密格式串，返回可重复使用的 fantasy::xorformat
+#define XORSTR_FORMAT(s)                                                                                               \
+    [] {                                                                                                               \
+        constexpr auto layout = fantasy::detail::format::measure(s);                                                   \
+        constexpr auto encrypted =                                                                                     \
+            fantasy::make_xorformat<COMPILETIME_SEED, layout.text_chars, layout.fields, layout.args>(s);               \
+        return encrypted;                                                                                              \
+    }
+
+// 有 <format> 时按参数类型校验整个格式串，与 std::format 的编译期检查相同；否则只做语法检查
+#if XORSTR_HAS_STD_FORMAT
+#define XORSTR_CHECK_FORMAT(s, args)                                                                                   \
+    (void)std::basic_format_string<std::remove_cvref_t<decltype((s)[0])>, decltype(args)...>(s)
+#else
+#define XORSTR_CHECK_FORMAT(s, args) (void)0
+#endif
+
+// 格式化为 std::basic_string：XOR_FORMAT("user {} failed {}", name, code)
+#define XOR_FORMAT(s, ...)                                                                                             \
+    [](const auto &...xorstr_args) {                                                                                   \
+        XORSTR_CHECK_FORMAT(s, xorstr_args);                                                                           \
+        static constexpr auto encrypted = XORSTR_FORMAT(s)();                                                          \
+        return encrypted.format(xorstr_args...);                                                                       \
+    }(__VA_ARGS__)
+
+// 格式化写入输出迭代器并返回写完后的迭代器：XOR_FORMAT_TO(std::back_inserter(log), "user {}", name)
+#define XOR_FORMAT_TO(out, s, ...)                                                                                     \
+    [](auto xorstr_out, const auto &...xorstr_args) {                                                                  \
+        XORSTR_CHECK_FORMAT(s, xorstr_args);                                                                           \
+        static constexpr auto encrypted = XORSTR_FORMAT(s)();                                                          \
+        return encrypted.format_to(std::move(xorstr_out), xorstr_args...);                                             \
+    }(out __VA_OPT__(, ) __VA_ARGS__)
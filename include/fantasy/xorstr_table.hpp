@@ -0,0 +1,239 @@
+#pragma once
+#include <fantasy/xorstr.hpp>
+
+namespace fantasy {
+    /**
+     * @brief 字符串表：多个字面量（含各自的 '\0'）首尾相接地打包进同一段密文，按偏移/长度索引。
+     * 没有逐条目的对齐与补齐，密钥流按整段密文的字下标派生，可以逐条目惰性解密，也可以一次性整段解密。
+     * XORSTR_DEDUP 不作用于字符串表，每张表都有自己的种子与密文。
+     * @tparam Keystream 密钥流策略，与 xorstr 相同；XOR_STR_TABLE 使用 XORSTR_KEYSTREAM
+     */
+    template <typename CharT, uint64_t Seed, typename Keystream, size_t... Ns> class xorstr_table {
+        static_assert(xorstr_char<CharT>, "xorstr_table supports char, wchar_t, char8_t, char16_t and char32_t");
+        static_assert(sizeof...(Ns) > 0, "xorstr_table needs at least one literal");
+
+        static constexpr size_t entry_count = sizeof...(Ns);
+
+        static constexpr std::array<size_t, entry_count> make_offsets() {
+            std::array<size_t, entry_count> offsets{};
+            constexpr std::array<size_t, entry_count> sizes{Ns...};
+            for (size_t i = 1; i < entry_count; ++i) {
+                offsets[i] = offsets[i - 1] + sizes[i - 1];
+            }
+            return offsets;
+        }
+
+    public:
+        using value_type = CharT;
+        using keystream_type = Keystream;
+
+        // 默认策略走表密钥 / 寄存器密钥的快速路径，其余策略统一通过策略接口
+        static constexpr bool default_keystream = std::is_same_v<Keystream, splitmix_keys>;
+
+        // 每个条目含 '\0' 的字符数
+        static constexpr std::array<size_t, entry_count> sizes{Ns...};
+
+        // 每个条目在表中的起始字符下标
+        static constexpr std::array<size_t, entry_count> offsets = make_offsets();
+
+        static constexpr size_t total_chars = (Ns + ...);
+
+        static constexpr size_t block_words =
+            align_up(sizeof(CharT) * total_chars, sizeof(uint64_t)) / sizeof(uint64_t);
+
+        static constexpr size_t storage_alignment = detail::storage_alignment<block_words * sizeof(uint64_t)>;
+
+        constexpr explicit xorstr_table(const CharT (&...strs)[Ns]) {
+            std::array<CharT, block_words * sizeof(uint64_t) / sizeof(CharT)> chars{};
+            size_t cursor = 0;
+            (
+                [&](const auto &str) {
+                    for (const CharT c : str) {
+                        chars[cursor++] = c;
+                    }
+                }(strs),
+                ...);
+            encrypted_blocks = std::bit_cast<std::array<uint64_t, block_words>>(chars);
+            const auto keys = Keystream::template keys<block_words>(Seed);
+            for (size_t i = 0; i < block_words; ++i) {
+                encrypted_blocks[i] ^= keys[i];
+            }
+        }
+
+        /**
+         * @brief 条目个数
+         */
+        [[nodiscard]] static constexpr size_t size() noexcept { return entry_count; }
+
+        /**
+         * @brief 第 index 个条目的长度（字符数，不含末尾的 '\0'）
+         */
+        [[nodiscard]] static constexpr size_t length(size_t index) noexcept { return sizes[index] - 1; }
+
+        /**
+         * @brief 惰性解密单个条目到返回的句柄中，表自身保持不变
+         */
+        template <size_t I> [[nodiscard]] inline revealed<CharT, sizes[I]> get() const {
+            static_assert(I < entry_count, "xorstr_table index out of range");
+            return revealed<CharT, sizes[I]>(
+                [this](uint64_t *plain) { decrypt_range(plain, offsets[I], sizes[I] * sizeof(CharT)); });
+        }
+
+        /**
+         * @brief 把第 index 个条目的 length(index) 个字符（不含 '\0'）写入 dst，表自身保持不变
+         * @return 写入的字符数；dst 放不下时不写入任何内容并返回 0
+         */
+        inline size_t decrypt_into(size_t index, std::span<CharT> dst) const noexcept {
+            const size_t chars = length(index);
+            if (dst.size() < chars) {
+                return 0;
+            }
+            decrypt_range(dst.data(), offsets[index], chars * sizeof(CharT));
+            return chars;
+        }
+
+        /**
+         * @brief 按内容查找条目，不解密任何条目：与每个长度相同的条目做常数时间比较。
+         * 表中不保存明文的哈希，短字符串的哈希可以被暴力还原
+         * @return 条目下标，找不到时返回 size()
+         */
+        [[nodiscard]] inline size_t find(std::basic_string_view<CharT> str) const noexcept {
+            for (size_t i = 0; i < entry_count; ++i) {
+                if (length(i) == str.size() && diff_entry(i, str.data()) == 0) {
+                    return i;
+                }
+            }
+            return entry_count;
+        }
+
+        /**
+         * @brief 第 index 个条目的明文是否等于 str，常数时间且不解密
+         */
+        [[nodiscard]] inline bool equals(size_t index, std::basic_string_view<CharT> str) const noexcept {
+            return length(index) == str.size() && diff_entry(index, str.data()) == 0;
+        }
+
+        /**
+         * @brief 一次长向量化遍历把整张表原地解密，适合在启动时批量展开。已是明文时直接返回。
+         */
+        inline void reveal_all() noexcept {
+            if (!in_plaintext) {
+                apply_keystream();
+                in_plaintext = true;
+            }
+        }
+
+        /**
+         * @brief 整张表原地重新加密。已是密文时直接返回。
+         */
+        inline void encrypt_all() noexcept {
+            if (in_plaintext) {
+                apply_keystream();
+                in_plaintext = false;
+            }
+        }
+
+        [[nodiscard]] bool is_revealed() const noexcept { return in_plaintext; }
+
+        /**
+         * @brief 第 index 个条目的原地明文，仅在 reveal_all() 之后、encrypt_all() 之前有效
+         */
+        [[nodiscard]] const CharT *c_str(size_t index) const noexcept {
+            return reinterpret_cast<const CharT *>(encrypted_blocks.data()) + offsets[index];
+        }
+
+        [[nodiscard]] std::basic_string_view<CharT> view(size_t index) const noexcept {
+            return {c_str(index), length(index)};
+        }
+
+        // 只有表模式会 odr-use，寄存器模式下不会出现在 .rodata 中
+        alignas(storage_alignment) static constexpr std::array<uint64_t, block_words> key_blocks =
+            make_key_blocks<block_words>(Seed);
+
+        alignas(storage_alignment) std::array<uint64_t, block_words> encrypted_blocks{0};
+
+    private:
+        inline uint64_t diff_entry(size_t index, const CharT *str) const noexcept {
+            const size_t offset = offsets[index] * sizeof(CharT);
+            const size_t bytes = length(index) * sizeof(CharT);
+            if (in_plaintext) {
+                return detail::diff_byte_range(str, encrypted_blocks.data(), offset, bytes, detail::zero_keystream{});
+            } else if constexpr (!default_keystream) {
+                return diff_policy_range(str, offset, bytes);
+            } else if constexpr (XORSTR_REGISTER_KEYS) {
+                return detail::diff_byte_range(str, encrypted_blocks.data(), offset, bytes,
+                                               detail::seed_keystream{detail::opaque(Seed)});
+            } else {
+                return detail::diff_byte_range(str, encrypted_blocks.data(), offset, bytes,
+                                               detail::table_keystream{detail::opaque(key_blocks.data())});
+            }
+        }
+
+        /**
+         * @brief 非默认密钥流的常数时间比较：分段生成密钥流（作用于全零输入），只有密钥流落在栈上，明文不会写入内存
+         */
+        inline uint64_t diff_policy_range(const CharT *str, size_t offset, size_t bytes) const noexcept {
+            constexpr size_t chunk_bytes = 32 * sizeof(uint64_t);
+            constexpr std::array<unsigned char, chunk_bytes> zeros{};
+            std::array<unsigned char, chunk_bytes> keys;
+            const auto *input = reinterpret_cast<const unsigned char *>(str);
+            const auto *cipher = reinterpret_cast<const unsigned char *>(encrypted_blocks.data()) + offset;
+            uint64_t diff = 0;
+            for (size_t first = 0; first < bytes; first += chunk_bytes) {
+                const size_t count = std::min(chunk_bytes, bytes - first);
+                Keystream::apply(keys.data(), zeros.data(), detail::opaque(Seed), offset + first, count);
+                for (size_t i = 0; i < count; ++i) {
+                    diff |= static_cast<uint64_t>(input[first + i] ^ keys[i] ^ cipher[first + i]);
+                }
+            }
+            detail::secure_wipe(keys.data(), sizeof(keys));
+            return diff;
+        }
+
+        inline void apply_keystream() noexcept {
+            if constexpr (!default_keystream) {
+                Keystream::apply(encrypted_blocks.data(), encrypted_blocks.data(), detail::opaque(Seed), 0,
+                                 block_words * sizeof(uint64_t));
+            } else if constexpr (XORSTR_REGISTER_KEYS) {
+                detail::xor_keystream<block_words>(encrypted_blocks.data(), encrypted_blocks.data(), Seed);
+            } else {
+                detail::xor_words<block_words>(encrypted_blocks.data(), encrypted_blocks.data(),
+                                               detail::opaque(key_blocks.data()));
+            }
+        }
+
+        /**
+         * @brief 把从第 first 个字符开始的 bytes 个字节的明文写入 dst（不要求对齐）
+         */
+        inline void decrypt_range(void *dst, size_t first, size_t bytes) const noexcept {
+            const size_t offset = first * sizeof(CharT);
+            if (in_plaintext) {
+                std::memcpy(dst, reinterpret_cast<const unsigned char *>(encrypted_blocks.data()) + offset, bytes);
+            } else if constexpr (!default_keystream) {
+                Keystream::apply(dst, reinterpret_cast<const unsigned char *>(encrypted_blocks.data()) + offset,
+                                 detail::opaque(Seed), offset, bytes);
+            } else if constexpr (XORSTR_REGISTER_KEYS) {
+                detail::xor_byte_range(dst, encrypted_blocks.data(), offset, bytes,
+                                       detail::seed_keystream{detail::opaque(Seed)});
+            } else {
+                detail::xor_byte_range(dst, encrypted_blocks.data(), offset, bytes,
+                                       detail::table_keystream{detail::opaque(key_blocks.data())});
+            }
+        }
+
+        // 当前 encrypted_blocks 中是否为明文
+        bool in_plaintext = false;
+    };
+
+    template <uint64_t Seed, typename Keystream = splitmix_keys, typename CharT, size_t... Ns>
+    constexpr auto make_xorstr_table(const CharT (&...strs)[Ns]) {
+        return xorstr_table<CharT, Seed, Keystream, Ns...>(strs...);
+    }
+} // namespace fantasy
+
+// 把多个字面量在常量表达式中打包并加密成一张表，返回表对象的副本
+#define XOR_STR_TABLE(...)                                                                                             \
+    [] {                                                                                                               \
+        constexpr auto table = fantasy::make_xorstr_table<COMPILETIME_SEED, XORSTR_KEYSTREAM>(__VA_ARGS__);            \
+        return table;                                                                                                  \
+    }()
@@ -0,0 +1,490 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fantasy/xorstr.hpp>
+#include <fantasy/xorstr_aes.hpp>
+#include <fantasy/xorstr_arena.hpp>
+#include <fantasy/xorstr_blob.hpp>
+#include <fantasy/xorstr_format.hpp>
+
+using namespace fantasy;
+
+namespace {
+    // 覆盖单字、跨 32 字节边界以及多块的长度（字符数，不含末尾的 '\0'）
+    constexpr std::size_t lengths[] = {1, 7, 31, 32, 33, 256, 1024, 4096};
+
+    // 冷缓存场景下轮换访问的数据总量，需大于末级缓存
+    constexpr std::size_t cold_footprint_bytes = 64u << 20;
+
+    template <typename CharT, std::size_t Length> struct text {
+        CharT data[Length + 1]{};
+
+        constexpr text() {
+            for (std::size_t i = 0; i < Length; ++i) {
+                data[i] = static_cast<CharT>('a' + i % 26);
+            }
+        }
+    };
+
+    template <typename CharT, std::size_t Length> constexpr text<CharT, Length> text_v{};
+
+    template <typename CharT, std::size_t Length>
+    constexpr auto encrypted_v = make_xorstr<0x5EEDULL + Length>(text_v<CharT, Length>.data);
+
+    template <typename CharT> const char *char_name() {
+        return sizeof(CharT) == 1 ? "char" : "wchar_t";
+    }
+
+    const char *isa_name(detail::isa level) {
+        switch (level) {
+        case detail::isa::sse2:
+            return "sse2";
+        case detail::isa::avx2:
+            return "avx2";
+        case detail::isa::avx512:
+            return "avx512";
+        case detail::isa::neon:
+            return "neon";
+        default:
+            return "scalar";
+        }
+    }
+
+    std::string label(const char *what, const char *type, std::size_t bytes, const char *cache = nullptr) {
+        std::string name = std::string(what) + "<" + type + "> " + std::to_string(bytes) + "B";
+        if (cache != nullptr) {
+            name += std::string(" ") + cache;
+        }
+        return name;
+    }
+
+    /**
+     * @brief 打乱访问顺序的对象池，每次调用落在不同的缓存行上，用于模拟冷缓存
+     */
+    template <typename T> struct cold_pool {
+        explicit cold_pool(const T &prototype)
+            : objects(std::max<std::size_t>(cold_footprint_bytes / sizeof(T), 1), prototype), order(objects.size()) {
+            std::iota(order.begin(), order.end(), std::size_t{0});
+            std::shuffle(order.begin(), order.end(), std::mt19937_64{42});
+        }
+
+        T &next() noexcept {
+            cursor = cursor + 1 == order.size() ? 0 : cursor + 1;
+            return objects[order[cursor]];
+        }
+
+        std::vector<T> objects;
+        std::vector<std::size_t> order;
+        std::size_t cursor = 0;
+    };
+
+    template <typename CharT, std::size_t Length> void bench_reveal() {
+        constexpr std::size_t bytes = Length * sizeof(CharT);
+        auto warm = encrypted_v<CharT, Length>;
+        BENCHMARK(label("reveal", char_name<CharT>(), bytes, "warm")) { return warm.reveal(); };
+
+        cold_pool pool(encrypted_v<CharT, Length>);
+        BENCHMARK(label("reveal", char_name<CharT>(), bytes, "cold")) { return pool.next().reveal(); };
+
+        std::vector<CharT> dst(Length + 1);
+        BENCHMARK(label("memcpy", char_name<CharT>(), bytes, "warm")) {
+            std::memcpy(dst.data(), text_v<CharT, Length>.data, bytes);
+            return dst[0];
+        };
+    }
+
+    template <typename CharT, std::size_t... Is> void bench_all_lengths(std::index_sequence<Is...>) {
+        (bench_reveal<CharT, lengths[Is]>(), ...);
+    }
+
+    std::vector<detail::isa> supported_isas() {
+        std::vector<detail::isa> levels;
+        for (const auto level : {detail::isa::scalar, detail::isa::sse2, detail::isa::avx2, detail::isa::avx512,
+                                 detail::isa::neon}) {
+            if (detail::cpu_supports(level)) {
+                levels.push_back(level);
+            }
+        }
+        return levels;
+    }
+
+    /**
+     * @brief 以固定时长反复调用，返回 ns/call
+     */
+    template <typename F> double measure_ns(F &&f) {
+        using clock = std::chrono::steady_clock;
+        std::size_t iterations = 0;
+        uint64_t sink = 0;
+        const auto start = clock::now();
+        auto now = start;
+        do {
+            for (int i = 0; i < 256; ++i) {
+                sink += f();
+            }
+            iterations += 256;
+            now = clock::now();
+        } while (now - start < std::chrono::milliseconds(20));
+        volatile uint64_t keep = sink;
+        (void)keep;
+        return std::chrono::duration<double, std::nano>(now - start).count() / static_cast<double>(iterations);
+    }
+} // namespace
+
+TEST_CASE("reveal() latency by length, character type and cache state", "[bench]") {
+    bench_all_lengths<char>(std::make_index_sequence<std::size(lengths)>{});
+    bench_all_lengths<wchar_t>(std::make_index_sequence<std::size(lengths)>{});
+}
+
+TEST_CASE("reveal() between scalar work (vzeroupper / frequency transitions)", "[bench][width]") {
+    // 在纯标量代码中穿插一次解密，模拟请求循环里的调用方式
+    auto obj = encrypted_v<char, 256>;
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    BENCHMARK("reveal<char> 256B + scalar work, XORSTR_VECTOR_WIDTH=" + std::to_string(XORSTR_VECTOR_WIDTH)) {
+        for (int i = 0; i < 16; ++i) {
+            state = indexed_key_gen(state, static_cast<std::size_t>(i));
+        }
+        return state ^ static_cast<uint64_t>(obj.reveal()[0]);
+    };
+}
+
+TEST_CASE("XOR kernel latency for each ISA path", "[bench][isa]") {
+    std::vector<uint64_t> src(4096 * sizeof(wchar_t) / sizeof(uint64_t), 0x0123456789ABCDEFULL);
+    std::vector<uint64_t> key(src.size(), 0xFEDCBA9876543210ULL);
+    std::vector<uint64_t> dst(src.size());
+
+    for (const auto level : supported_isas()) {
+        const detail::xor_kernel kernel = detail::kernel_for(level);
+        for (const std::size_t length : lengths) {
+            const std::size_t words = align_up(length, sizeof(uint64_t)) / sizeof(uint64_t);
+            BENCHMARK(label("kernel", isa_name(level), words * sizeof(uint64_t))) {
+                kernel(dst.data(), src.data(), key.data(), words);
+                return dst[0];
+            };
+        }
+    }
+}
+
+TEST_CASE("Throughput summary (GB/s)", "[bench][throughput]") {
+    std::vector<uint64_t> src(4096 / sizeof(uint64_t), 0x0123456789ABCDEFULL);
+    std::vector<uint64_t> key(src.size(), 0xFEDCBA9876543210ULL);
+    std::vector<uint64_t> dst(src.size());
+
+    std::printf("\n%-10s %8s %12s %10s\n", "path", "bytes", "ns/call", "GB/s");
+    for (const auto level : supported_isas()) {
+        const detail::xor_kernel kernel = detail::kernel_for(level);
+        for (const std::size_t bytes : {32, 256, 1024, 4096}) {
+            const double ns = measure_ns([&] {
+                kernel(dst.data(), src.data(), key.data(), bytes / sizeof(uint64_t));
+                return dst[0];
+            });
+            std::printf("%-10s %8zu %12.2f %10.2f\n", isa_name(level), static_cast<std::size_t>(bytes), ns,
+                        static_cast<double>(bytes) / ns);
+        }
+    }
+    for (const std::size_t bytes : {32, 256, 1024, 4096}) {
+        const double ns = measure_ns([&] {
+            std::memcpy(dst.data(), src.data(), bytes);
+            return dst[0];
+        });
+        std::printf("%-10s %8zu %12.2f %10.2f\n", "memcpy", static_cast<std::size_t>(bytes), ns,
+                    static_cast<double>(bytes) / ns);
+    }
+    auto warm = encrypted_v<char, 4096>;
+    const double ns = measure_ns([&] { return static_cast<uint64_t>(warm.reveal()[0]); });
+    std::printf("%-10s %8d %12.2f %10.2f\n", "reveal()", 4096, ns, 4096.0 / ns);
+    SUCCEED();
+}
+
+TEST_CASE("Register key expansion for each ISA path vs the key table (GB/s)", "[bench][keys]") {
+    std::vector<uint64_t> src(4096 / sizeof(uint64_t), 0x0123456789ABCDEFULL);
+    std::vector<uint64_t> key(src.size(), 0xFEDCBA9876543210ULL);
+    std::vector<uint64_t> dst(src.size());
+    const uint64_t seed = detail::opaque(0x5EEDULL);
+
+    std::printf("\n%-18s %8s %12s %10s\n", "path", "bytes", "ns/call", "GB/s");
+    for (const std::size_t bytes : {32, 256, 1024, 4096}) {
+        const std::size_t words = bytes / sizeof(uint64_t);
+        const detail::xor_kernel table = detail::kernel_for(detail::runtime_isa());
+        const double table_ns = measure_ns([&] {
+            table(dst.data(), src.data(), key.data(), words);
+            return dst[0];
+        });
+        std::printf("%-18s %8zu %12.2f %10.2f\n", "table", bytes, table_ns, static_cast<double>(bytes) / table_ns);
+        for (const auto level : supported_isas()) {
+            const detail::keystream_kernel kernel = detail::keystream_kernel_for(level);
+            const double ns = measure_ns([&] {
+                kernel(dst.data(), src.data(), seed, 0, words);
+                return dst[0];
+            });
+            const std::string name = std::string("register ") + isa_name(level);
+            std::printf("%-18s %8zu %12.2f %10.2f\n", name.c_str(), bytes, ns, static_cast<double>(bytes) / ns);
+        }
+    }
+    SUCCEED();
+}
+
+TEST_CASE("Batch reveal of many short objects (start-up warm-up)", "[bench][batch]") {
+    // 模拟启动时逐个展开约 2000 个配置键
+    std::vector objs(2048, encrypted_v<char, 24>);
+    BENCHMARK("decrypt() + encrypt() one by one, 2048 x 24B") {
+        for (auto &obj : objs) {
+            (void)obj.decrypt();
+        }
+        for (auto &obj : objs) {
+            obj.encrypt();
+        }
+        return objs[0].encrypted_blocks[0];
+    };
+    BENCHMARK("reveal_all() + encrypt_all(), 2048 x 24B") {
+        reveal_all(objs);
+        encrypt_all(objs);
+        return objs[0].encrypted_blocks[0];
+    };
+
+    auto a = encrypted_v<char, 7>;
+    auto b = encrypted_v<char, 31>;
+    auto c = encrypted_v<char, 33>;
+    auto d = encrypted_v<wchar_t, 7>;
+    BENCHMARK("reveal_all(a, b, c, d) + encrypt_all(a, b, c, d)") {
+        reveal_all(a, b, c, d);
+        encrypt_all(a, b, c, d);
+        return a.encrypted_blocks[0];
+    };
+}
+
+TEST_CASE("Large blob decryption, single-threaded and parallel (GB/s)", "[bench][xorblob]") {
+    static constexpr auto blob = make_xorblob<0xB10BULL>(text_v<char, (std::size_t{1} << 18) - 1>.data);
+    std::vector<std::byte> out(blob.size());
+
+    std::printf("\n%-22s %10s %12s %10s\n", "path", "bytes", "us/call", "GB/s");
+    const auto report = [&](const char *name, auto &&decrypt) {
+        const double ns = measure_ns([&] {
+            decrypt();
+            return static_cast<uint64_t>(out[0]);
+        });
+        std::printf("%-22s %10zu %12.2f %10.2f\n", name, blob.size(), ns / 1000.0,
+                    static_cast<double>(blob.size()) / ns);
+    };
+    report("read()", [&] { blob.read(0, std::span(out)); });
+    for (const unsigned threads : {2u, 4u, 8u}) {
+        const std::string name = "read_parallel(" + std::to_string(threads) + ")";
+        report(name.c_str(), [&] { blob.read_parallel(0, std::span(out), threads); });
+    }
+    SUCCEED();
+}
+
+TEST_CASE("Prefix match on a long string: full decrypt vs lazy view", "[bench][lazy]") {
+    const auto obj = encrypted_v<char, 4096>;
+    const std::string_view prefix = "abcdefgh";
+    BENCHMARK("reveal_scoped().view().starts_with(), 4096B") { return obj.reveal_scoped().view().starts_with(prefix); };
+    BENCHMARK("ranges::mismatch(prefix, lazy()), 4096B") {
+        return std::ranges::mismatch(prefix, obj.lazy()).in1 == prefix.end();
+    };
+    BENCHMARK("chunks<8>() first chunk == prefix, 4096B") { return *obj.chunks<8>().begin() == prefix; };
+}
+
+TEST_CASE("Token comparison: decrypt + compare vs equals()", "[bench][compare]") {
+    const auto token = encrypted_v<char, 32>;
+    const std::string input(text_v<char, 32>.data);
+    BENCHMARK("strcmp(reveal_scoped().c_str(), input), 32B") {
+        return std::strcmp(token.reveal_scoped().c_str(), input.c_str()) == 0;
+    };
+    BENCHMARK("equals(input), 32B") { return token.equals(input); };
+}
+
+namespace {
+    template <std::size_t Length> void report_wipe_overhead() {
+        const auto prototype = encrypted_v<char, Length>;
+        auto in_place = prototype;
+        const double plain_ns = measure_ns([&] {
+            auto copy = prototype;
+            return static_cast<uint64_t>(copy.decrypt()[Length - 1]);
+        });
+        const double zero_ns = measure_ns([&] {
+            auto copy = prototype;
+            const auto plain = copy.template reveal_guarded<wipe_policy::zero>();
+            return static_cast<uint64_t>(plain.data()[Length - 1]);
+        });
+        const double reencrypt_ns = measure_ns([&] {
+            const auto plain = in_place.reveal_guarded();
+            return static_cast<uint64_t>(plain.data()[Length - 1]);
+        });
+        const double volatile_ns = measure_ns([&] {
+            auto copy = prototype;
+            const uint64_t last = static_cast<uint64_t>(copy.decrypt()[Length - 1]);
+            auto *bytes = reinterpret_cast<volatile unsigned char *>(copy.encrypted_blocks.data());
+            for (std::size_t i = 0; i < sizeof(copy.encrypted_blocks); ++i) {
+                bytes[i] = 0;
+            }
+            return last;
+        });
+        std::printf("%8zu %14.2f %14.2f %14.2f %14.2f\n", Length, plain_ns, zero_ns, reencrypt_ns, volatile_ns);
+    }
+} // namespace
+
+TEST_CASE("Overhead of wiping plaintext on scope exit (ns/call)", "[bench][wipe]") {
+    std::printf("\n%8s %14s %14s %14s %14s\n", "chars", "copy+decrypt", "guard(zero)", "guard(reenc)", "volatile loop");
+    report_wipe_overhead<7>();
+    report_wipe_overhead<31>();
+    report_wipe_overhead<256>();
+    report_wipe_overhead<1024>();
+    report_wipe_overhead<4096>();
+    SUCCEED();
+}
+
+TEST_CASE("AES-CTR key stream vs the XOR key stream (GB/s)", "[bench][aes]") {
+    using detail::aes::backend;
+    const std::vector<std::pair<const char *, backend>> backends = {
+        {"aes soft", backend::soft}, {"aes-ni", backend::aesni}, {"vaes", backend::vaes}, {"armv8", backend::armv8}};
+    std::vector<uint64_t> src(4096 / sizeof(uint64_t), 0x0123456789ABCDEFULL);
+    std::vector<uint64_t> key(src.size(), 0xFEDCBA9876543210ULL);
+    std::vector<uint64_t> dst(src.size());
+    const detail::aes::key_material km = detail::aes::derive(0xAE5ULL);
+
+    std::printf("\n%-14s %8s %12s %10s\n", "path", "bytes", "ns/call", "GB/s");
+    const auto report = [](const char *name, std::size_t bytes, double ns) {
+        std::printf("%-14s %8zu %12.2f %10.2f\n", name, bytes, ns, static_cast<double>(bytes) / ns);
+    };
+    for (const std::size_t bytes : {32, 256, 1024, 4096}) {
+        const detail::xor_kernel kernel = detail::kernel_for(detail::runtime_isa());
+        report("xor table", bytes, measure_ns([&] {
+                   kernel(dst.data(), src.data(), key.data(), bytes / sizeof(uint64_t));
+                   return dst[0];
+               }));
+        report("xor register", bytes, measure_ns([&] {
+                   detail::seed_keystream{detail::opaque(0xAE5ULL)}.apply(dst.data(), src.data(), 0,
+                                                                          bytes / sizeof(uint64_t));
+                   return dst[0];
+               }));
+        for (const auto &[name, level] : backends) {
+            if (!detail::aes::cpu_supports(level)) {
+                continue;
+            }
+            const detail::aes::ctr_kernel kernel_aes = detail::aes::kernel_for(level);
+            report(name, bytes, measure_ns([&] {
+                       kernel_aes(dst.data(), src.data(), km, 0, bytes);
+                       return dst[0];
+                   }));
+        }
+    }
+    auto warm = make_xorstr<0xAE6ULL, aes_ctr_keys>(text_v<char, 4096>.data);
+    report("reveal() aes", 4096, measure_ns([&] { return static_cast<uint64_t>(warm.reveal()[0]); }));
+    SUCCEED();
+}
+
+TEST_CASE("Per-request decryption: std::string vs thread-local arena (ns/request)", "[bench][arena]") {
+    // 一次请求用到的若干加密字面量，长度覆盖短串到 1 KB；std::string 路径与 std::string(XOR_STR(...)) 相同
+    const auto request_with_strings = [] {
+        uint64_t sum = 0;
+        sum += std::string(auto(encrypted_v<char, 31>).reveal()).size();
+        sum += std::string(auto(encrypted_v<char, 256>).reveal()).size();
+        sum += std::string(auto(encrypted_v<char, 1024>).reveal()).size();
+        sum += std::string(auto(encrypted_v<char, 1024>).reveal()).size();
+        return sum;
+    };
+    const auto request_with_arena = [] {
+        const xorstr_arena::scope scope;
+        uint64_t sum = 0;
+        sum += reveal_into_arena(encrypted_v<char, 31>).size();
+        sum += reveal_into_arena(encrypted_v<char, 256>).size();
+        sum += reveal_into_arena(encrypted_v<char, 1024>).size();
+        sum += reveal_into_arena(encrypted_v<char, 1024>).size();
+        return sum;
+    };
+
+    std::printf("\n%-12s %8s %14s %14s\n", "path", "threads", "ns/request", "requests/us");
+    const auto report = [](const char *name, unsigned threads, double ns) {
+        std::printf("%-12s %8u %14.2f %14.2f\n", name, threads, ns, 1000.0 * threads / ns);
+    };
+    const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    for (const unsigned threads : {1u, hardware}) {
+        for (const auto &[name, request] :
+             {std::pair<const char *, uint64_t (*)()>{"std::string", +request_with_strings},
+              std::pair<const char *, uint64_t (*)()>{"arena", +request_with_arena}}) {
+            std::vector<double> per_thread(threads);
+            std::vector<std::thread> workers;
+            for (unsigned t = 0; t < threads; ++t) {
+                workers.emplace_back([&, t] { per_thread[t] = measure_ns(request); });
+            }
+            for (std::thread &worker : workers) {
+                worker.join();
+            }
+            report(name, threads, std::accumulate(per_thread.begin(), per_thread.end(), 0.0) / threads);
+        }
+        if (hardware == 1) {
+            break;
+        }
+    }
+    SUCCEED();
+}
+
+namespace {
+    uint64_t consume_plain(const char *plain) {
+        return static_cast<uint64_t>(plain[0]);
+    }
+
+    // 经 volatile 函数指针调用的外部函数，明文指针逃逸后对象必须真正放在栈上
+    uint64_t (*volatile consume)(const char *) = &consume_plain;
+
+    // 典型的小函数：在栈上构造一个对象、解密并把明文交给另一个函数，相当于 f(XOR_STR("..."))
+    template <std::size_t Length> uint64_t leaf_reveal() {
+        auto local = encrypted_v<char, Length>;
+        return consume(local.reveal());
+    }
+
+    template <std::size_t Length> void report_leaf() {
+        using xor_type = std::remove_const_t<decltype(encrypted_v<char, Length>)>;
+        // 经 volatile 函数指针调用，阻止内联，测到的是完整的 prologue / epilogue
+        uint64_t (*volatile leaf)() = &leaf_reveal<Length>;
+        const double ns = measure_ns([&] { return leaf(); });
+        std::printf("%8zu %10zu %10zu %12.2f\n", Length, alignof(xor_type), sizeof(xor_type), ns);
+    }
+} // namespace
+
+TEST_CASE("Small leaf functions under the storage layout policy (ns/call)", "[bench][layout]") {
+    std::printf("\nXORSTR_STORAGE_ALIGNMENT=%d\n%8s %10s %10s %12s\n", XORSTR_STORAGE_ALIGNMENT, "chars", "alignof",
+                "sizeof", "ns/call");
+    report_leaf<7>();
+    report_leaf<31>();
+    report_leaf<256>();
+    report_leaf<1024>();
+    SUCCEED();
+}
+
+TEST_CASE("Formatting with an encrypted format string (ns/call)", "[bench][format]") {
+    const char *user = "alice";
+    int failures = 3;
+    char out[128];
+
+    std::printf("\n%-30s %12s\n", "path", "ns/call");
+    const auto report = [](const char *name, double ns) { std::printf("%-30s %12.2f\n", name, ns); };
+    // 解密出明文格式串，再在运行期解析
+    report("snprintf(XOR_STR(fmt))", measure_ns([&] {
+               const int n = std::snprintf(out, sizeof(out), XOR_STR("user %s failed %d times"), user, failures);
+               return static_cast<uint64_t>(n) + static_cast<uint64_t>(out[0]);
+           }));
+#if XORSTR_HAS_STD_FORMAT
+    report("vformat_to(XOR_STR_VIEW(fmt))", measure_ns([&] {
+               char *end = std::vformat_to(out, XOR_STR_VIEW("user {} failed {} times"),
+                                           std::make_format_args(user, failures));
+               return static_cast<uint64_t>(end - out) + static_cast<uint64_t>(out[0]);
+           }));
+#endif
+    // 编译期解析，文本段直接解密进输出缓冲区
+    report("XOR_FORMAT_TO", measure_ns([&] {
+               char *end = XOR_FORMAT_TO(out, "user {} failed {} times", user, failures);
+               return static_cast<uint64_t>(end - out) + static_cast<uint64_t>(out[0]);
+           }));
+    report("XOR_FORMAT (std::string)", measure_ns([&] {
+               return static_cast<uint64_t>(XOR_FORMAT("user {} failed {} times", user, failures).size());
+           }));
+    SUCCEED();
+}
@@ -0,0 +1,190 @@
+# 代码生成回归检查：为每类典型调用点生成 1 个与 K 个调用点的翻译单元，分别编译后按差值求出
+# 每个调用点的 .text / .rodata 字节数与静态指令条数，与基线比较，超出容差即失败
+#
+# cmake -DXORSTR_CXX=<编译器> -DXORSTR_CXX_FLAGS="<公共参数>" -DXORSTR_CXX_FRONTEND=<GNU|MSVC>
+#       -DXORSTR_TOOLCHAIN=<基线中的工具链名，如 GNU-12> -DXORSTR_OBJDUMP=<objdump 或 dumpbin>
+#       -DXORSTR_CODEGEN_CONFIGS="O2=-O2;Os=-Os" -DXORSTR_BASELINE=<基线文件> -DXORSTR_WORK_DIR=<目录>
+#       [-DXORSTR_TOLERANCE=<百分比，默认 10>] [-DXORSTR_UPDATE_BASELINE=ON] -P codegen_bench.cmake
+cmake_minimum_required(VERSION 3.19) # file(READ) 与 string(REGEX MATCHALL) 的行为
+
+if (NOT XORSTR_TOLERANCE)
+    set(XORSTR_TOLERANCE 10)
+endif()
+if (NOT XORSTR_OBJDUMP)
+    message(FATAL_ERROR "no objdump / dumpbin found, cannot inspect object files")
+endif()
+
+# 每类调用点：名称|字面量长度|调用点表达式（@LIT@ 替换为字面量），每个调用点生成为 void site_<i>(std::string_view s)
+set(cases
+    "str8|8|sink(XOR_STR(\"@LIT@\"))"
+    "str32|32|sink(XOR_STR(\"@LIT@\"))"
+    "str64|64|sink(XOR_STR(\"@LIT@\"))"
+    "str256|256|sink(XOR_STR(\"@LIT@\"))"
+    "wide16|16|wsink(XOR_STR(L\"@LIT@\"))"
+    "view32|32|sink_view(XOR_STR_VIEW(\"@LIT@\"))"
+    "equals16|16|sink_bool(XORSTR_ENCRYPT(\"@LIT@\")().equals(s))"
+    "cached32|32|sink_view(XOR_STR_CACHED(\"@LIT@\"))"
+)
+# K 个调用点与 1 个调用点之差再除以 K - 1，抵消内核、分派表等每个翻译单元只有一份的部分
+set(sites 17)
+
+set(prelude "#include <fantasy/xorstr.hpp>\n#include <string_view>\n")
+string(APPEND prelude "void sink(const char *);\nvoid wsink(const wchar_t *);\nvoid sink_view(std::string_view);\n")
+string(APPEND prelude "void sink_bool(bool);\n")
+set(alphabet "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789")
+
+file(MAKE_DIRECTORY ${XORSTR_WORK_DIR})
+
+# 统计目标文件中 .text* / .rodata*（COFF 为 .text$* / .rdata）的字节数与指令条数
+function(measure object out_text out_rodata out_insns)
+    set(text 0)
+    set(rodata 0)
+    set(insns 0)
+    if (XORSTR_CXX_FRONTEND STREQUAL "MSVC")
+        execute_process(COMMAND ${XORSTR_OBJDUMP} /nologo /headers ${object} OUTPUT_VARIABLE headers)
+        string(REGEX MATCHALL "SECTION HEADER #[0-9A-F]+\n *[^ \n]+ name\n[^\n]*\n[^\n]*\n *[0-9A-F]+ size of raw data"
+               sections "${headers}")
+        foreach (section IN LISTS sections)
+            string(REGEX MATCH "\n *([^ \n]+) name\n" _ "${section}")
+            set(name ${CMAKE_MATCH_1})
+            string(REGEX MATCH "([0-9A-F]+) size of raw data" _ "${section}")
+            math(EXPR bytes "0x${CMAKE_MATCH_1}")
+            if (name MATCHES "^\\.text")
+                math(EXPR text "${text} + ${bytes}")
+            elseif (name MATCHES "^\\.rdata")
+                math(EXPR rodata "${rodata} + ${bytes}")
+            endif()
+        endforeach()
+        execute_process(COMMAND ${XORSTR_OBJDUMP} /nologo /disasm:nobytes ${object} OUTPUT_VARIABLE listing)
+        string(REGEX MATCHALL "\n  [0-9A-F]+: [a-z]" lines "${listing}")
+        string(REGEX MATCHALL "\n  [0-9A-F]+: (int +3|nop)" padding "${listing}")
+    else()
+        execute_process(COMMAND ${XORSTR_OBJDUMP} -h ${object} OUTPUT_VARIABLE headers)
+        string(REGEX MATCHALL "\n *[0-9]+ +[^ \n]+ +[0-9a-f]+" sections "${headers}")
+        foreach (section IN LISTS sections)
+            string(REGEX MATCH "([^ \n]+) +([0-9a-f]+)$" _ "${section}")
+            set(name ${CMAKE_MATCH_1})
+            math(EXPR bytes "0x${CMAKE_MATCH_2}")
+            if (name MATCHES "^\\.text")
+                math(EXPR text "${text} + ${bytes}")
+            elseif (name MATCHES "^\\.rodata")
+                math(EXPR rodata "${rodata} + ${bytes}")
+            endif()
+        endforeach()
+        execute_process(COMMAND ${XORSTR_OBJDUMP} -d --no-show-raw-insn ${object} OUTPUT_VARIABLE listing)
+        string(REGEX MATCHALL "\n +[0-9a-f]+:[ \t]+[a-z]" lines "${listing}")
+        # 函数之间的对齐填充不计入指令条数
+        string(REGEX MATCHALL "\n +[0-9a-f]+:[ \t]+(nop|xchg +%ax,%ax|data16|cs nop|int3)" padding "${listing}")
+    endif()
+    list(LENGTH lines total)
+    list(LENGTH padding nops)
+    math(EXPR insns "${total} - ${nops}")
+    set(${out_text} ${text} PARENT_SCOPE)
+    set(${out_rodata} ${rodata} PARENT_SCOPE)
+    set(${out_insns} ${insns} PARENT_SCOPE)
+endfunction()
+
+function(compile source object flags)
+    if (XORSTR_CXX_FRONTEND STREQUAL "MSVC")
+        set(output_flag "/Fo${object}")
+    else()
+        set(output_flag -o ${object})
+    endif()
+    execute_process(
+        COMMAND ${XORSTR_CXX} ${XORSTR_CXX_FLAGS} ${flags} -c ${source} ${output_flag}
+        RESULT_VARIABLE result
+        ERROR_VARIABLE errors
+    )
+    if (NOT result EQUAL 0)
+        message(FATAL_ERROR "compiling ${source} failed:\n${errors}")
+    endif()
+endfunction()
+
+# 读入基线：<工具链>\t<配置>\t<调用点>\t<text>\t<rodata>\t<指令数>，# 开头为注释
+set(baseline_lines "")
+if (EXISTS ${XORSTR_BASELINE})
+    file(STRINGS ${XORSTR_BASELINE} baseline_lines REGEX "^[^#]")
+endif()
+
+set(report "")
+set(failures "")
+message("toolchain ${XORSTR_TOOLCHAIN}, tolerance ${XORSTR_TOLERANCE}%, per-site numbers")
+message("config\tcase\ttext\trodata\tinsns\tbaseline")
+foreach (config IN LISTS XORSTR_CODEGEN_CONFIGS)
+    string(FIND "${config}" "=" split)
+    string(SUBSTRING "${config}" 0 ${split} config_name)
+    math(EXPR split "${split} + 1")
+    string(SUBSTRING "${config}" ${split} -1 config_flags)
+    separate_arguments(config_flags NATIVE_COMMAND "${config_flags}")
+
+    foreach (case IN LISTS cases)
+        string(REGEX MATCH "^([^|]+)\\|([0-9]+)\\|(.*)$" _ "${case}")
+        set(case_name ${CMAKE_MATCH_1})
+        set(length ${CMAKE_MATCH_2})
+        set(expression "${CMAKE_MATCH_3}")
+
+        foreach (count 1 ${sites})
+            set(content "${prelude}")
+            math(EXPR last "${count} - 1")
+            foreach (i RANGE ${last})
+                # 每个调用点的内容都不同，避免编译器合并相同常量
+                string(RANDOM LENGTH ${length} ALPHABET ${alphabet} RANDOM_SEED ${i} literal)
+                string(REPLACE "@LIT@" "${literal}" site "${expression}")
+                string(APPEND content "void site_${i}(std::string_view s) { ${site}; }\n")
+            endforeach()
+            set(source "${XORSTR_WORK_DIR}/${config_name}_${case_name}_${count}.cpp")
+            set(object "${XORSTR_WORK_DIR}/${config_name}_${case_name}_${count}.o")
+            file(WRITE ${source} "${content}")
+            compile(${source} ${object} "${config_flags}")
+            measure(${object} text_${count} rodata_${count} insns_${count})
+        endforeach()
+
+        math(EXPR text "(${text_${sites}} - ${text_1}) / (${sites} - 1)")
+        math(EXPR rodata "(${rodata_${sites}} - ${rodata_1}) / (${sites} - 1)")
+        math(EXPR insns "(${insns_${sites}} - ${insns_1}) / (${sites} - 1)")
+        string(APPEND report "${XORSTR_TOOLCHAIN}\t${config_name}\t${case_name}\t${text}\t${rodata}\t${insns}\n")
+
+        set(expected "")
+        foreach (line IN LISTS baseline_lines)
+            if (line MATCHES "^${XORSTR_TOOLCHAIN}\t${config_name}\t${case_name}\t([0-9]+)\t([0-9]+)\t([0-9]+)$")
+                set(expected ${CMAKE_MATCH_1} ${CMAKE_MATCH_2} ${CMAKE_MATCH_3})
+            endif()
+        endforeach()
+        if (expected)
+            set(status "")
+            foreach (metric IN ITEMS text rodata insns)
+                list(POP_FRONT expected base)
+                math(EXPR limit "(${base} * (100 + ${XORSTR_TOLERANCE}) + 99) / 100")
+                if (${${metric}} GREATER ${limit})
+                    string(APPEND status " ${metric} ${base}->${${metric}}")
+                endif()
+            endforeach()
+            if (status)
+                list(APPEND failures "${config_name}/${case_name}:${status}")
+                set(status "REGRESSED")
+            else()
+                set(status "ok")
+            endif()
+        else()
+            set(status "no baseline")
+        endif()
+        message("${config_name}\t${case_name}\t${text}\t${rodata}\t${insns}\t${status}")
+    endforeach()
+endforeach()
+
+if (XORSTR_UPDATE_BASELINE)
+    # 保留其他工具链的条目，替换当前工具链的条目
+    set(content "# toolchain\tconfig\tcase\ttext\trodata\tinsns (per call site)\n")
+    foreach (line IN LISTS baseline_lines)
+        if (NOT line MATCHES "^${XORSTR_TOOLCHAIN}\t")
+            string(APPEND content "${line}\n")
+        endif()
+    endforeach()
+    string(APPEND content "${report}")
+    file(WRITE ${XORSTR_BASELINE} "${content}")
+    message("baseline for ${XORSTR_TOOLCHAIN} written to ${XORSTR_BASELINE}")
+elseif (failures)
+    list(JOIN failures "\n  " failures)
+    message(FATAL_ERROR "code generation regressed by more than ${XORSTR_TOLERANCE}%:\n  ${failures}\n"
+                        "If the growth is intended, rerun with -DXORSTR_UPDATE_BASELINE=ON.")
+endif()
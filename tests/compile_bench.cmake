@@ -0,0 +1,65 @@
+# 编译期基准：生成含 N 个 XOR_STR 调用点、每个字面量 L 字节的翻译单元，按每个配置统计编译耗时与目标文件大小
+#
+# cmake -DXORSTR_CXX=<编译器> -DXORSTR_CXX_FLAGS="<公共参数>" -DXORSTR_WORK_DIR=<目录>
+#       [-DXORSTR_BENCH_CONFIGS="O2=-O2;O0-g=-O0 -g"] [-DXORSTR_BENCH_SITES="100;300;1000"]
+#       [-DXORSTR_BENCH_LENGTHS="8;64;512;1024"] -P compile_bench.cmake
+cmake_minimum_required(VERSION 3.23) # string(TIMESTAMP) 的 %f
+
+if (NOT XORSTR_BENCH_CONFIGS)
+    set(XORSTR_BENCH_CONFIGS "O2=-O2")
+endif()
+if (NOT XORSTR_BENCH_SITES)
+    set(XORSTR_BENCH_SITES 100 300 1000)
+endif()
+if (NOT XORSTR_BENCH_LENGTHS)
+    set(XORSTR_BENCH_LENGTHS 8 64 512 1024)
+endif()
+
+file(MAKE_DIRECTORY ${XORSTR_WORK_DIR})
+set(alphabet "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789")
+
+message("config\tsites\tlength\tcompile_ms\tobject_bytes")
+foreach (config IN LISTS XORSTR_BENCH_CONFIGS)
+    string(FIND "${config}" "=" split)
+    string(SUBSTRING "${config}" 0 ${split} config_name)
+    math(EXPR split "${split} + 1")
+    string(SUBSTRING "${config}" ${split} -1 config_flags)
+    separate_arguments(config_flags NATIVE_COMMAND "${config_flags}")
+
+    foreach (sites IN LISTS XORSTR_BENCH_SITES)
+        foreach (length IN LISTS XORSTR_BENCH_LENGTHS)
+            set(source "${XORSTR_WORK_DIR}/${config_name}_${sites}_${length}.cpp")
+            set(object "${XORSTR_WORK_DIR}/${config_name}_${sites}_${length}.o")
+
+            set(content "#include <fantasy/xorstr.hpp>\n#include <string_view>\nvoid sink(std::string_view);\n")
+            math(EXPR last "${sites} - 1")
+            foreach (i RANGE ${last})
+                # 每个调用点的内容都不同，避免编译器合并相同常量
+                string(RANDOM LENGTH ${length} ALPHABET ${alphabet} RANDOM_SEED ${i} literal)
+                string(APPEND content "void site_${i}() { sink(XOR_STR_VIEW(\"${literal}\")); }\n")
+            endforeach()
+            file(WRITE ${source} "${content}")
+
+            if (XORSTR_CXX_FRONTEND STREQUAL "MSVC")
+                set(output_flag "/Fo${object}")
+            else()
+                set(output_flag -o ${object})
+            endif()
+
+            string(TIMESTAMP start "%s%f")
+            execute_process(
+                COMMAND ${XORSTR_CXX} ${XORSTR_CXX_FLAGS} ${config_flags} -c ${source} ${output_flag}
+                RESULT_VARIABLE result
+                ERROR_VARIABLE errors
+            )
+            string(TIMESTAMP stop "%s%f")
+            if (NOT result EQUAL 0)
+                message(FATAL_ERROR "compiling ${source} failed:\n${errors}")
+            endif()
+
+            math(EXPR elapsed_ms "(${stop} - ${start}) / 1000")
+            file(SIZE ${object} object_bytes)
+            message("${config_name}\t${sites}\t${length}\t${elapsed_ms}\t${object_bytes}")
+        endforeach()
+    endforeach()
+endforeach()